@@ -1,16 +1,47 @@
 cmake_minimum_required(VERSION 3.9)
 set(SERENITY_MODULE_FILES
+  "Serenity/Calculators/BlockScreening.cpp"
+  "Serenity/Calculators/BlockScreening.h"
   "Serenity/Calculators/CalculatorBase.cpp"
   "Serenity/Calculators/CalculatorBase.h"
   "Serenity/Calculators/CCCalculator.cpp"
   "Serenity/Calculators/CCCalculator.h"
+  "Serenity/Calculators/CM5Charges.cpp"
+  "Serenity/Calculators/CM5Charges.h"
   "Serenity/Calculators/DFTCalculator.cpp"
   "Serenity/Calculators/DFTCalculator.h"
+  "Serenity/Calculators/DisplacementJob.cpp"
+  "Serenity/Calculators/DisplacementJob.h"
+  "Serenity/Calculators/DisplacementWorkerPool.cpp"
+  "Serenity/Calculators/DisplacementWorkerPool.h"
+  "Serenity/Calculators/EmbeddingCalculator.cpp"
+  "Serenity/Calculators/EmbeddingCalculator.h"
+  "Serenity/Calculators/GuessCache.cpp"
+  "Serenity/Calculators/GuessCache.h"
   "Serenity/Calculators/HFCalculator.cpp"
   "Serenity/Calculators/HFCalculator.h"
+  "Serenity/Calculators/LibintEnginePool.cpp"
+  "Serenity/Calculators/LibintEnginePool.h"
+  "Serenity/Calculators/MP2Calculator.cpp"
+  "Serenity/Calculators/MP2Calculator.h"
+  "Serenity/Calculators/OutputContext.cpp"
+  "Serenity/Calculators/OutputContext.h"
+  "Serenity/Calculators/PropertyPlanner.cpp"
+  "Serenity/Calculators/PropertyPlanner.h"
+  "Serenity/Calculators/ResultCache.cpp"
+  "Serenity/Calculators/ResultCache.h"
   "Serenity/Calculators/ScineSettings.cpp"
   "Serenity/Calculators/ScineSettings.h"
+  "Serenity/Calculators/ScratchManager.cpp"
+  "Serenity/Calculators/ScratchManager.h"
+  "Serenity/Calculators/SerenityState.cpp"
   "Serenity/Calculators/SerenityState.h"
   "Serenity/SerenityModule.cpp"
   "Serenity/SerenityModule.h"
 )
+set(SERENITY_WORKER_FILES
+  "Serenity/DisplacementWorker.cpp"
+)
+set(SERENITY_PYTHON_FILES
+  "Python/SerenityPython.cpp"
+)
@@ -0,0 +1,98 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+/* Internal Includes */
+#include "Serenity/Calculators/CalculatorBase.h"
+/* External Includes */
+#include <Core/Interfaces/Calculator.h>
+#include <pybind11/eigen.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <stdexcept>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace {
+/*
+ * The calculators are handed out by the module manager as Core::Calculator,
+ * their Serenity specific functionality is reached through the base class.
+ */
+Scine::Serenity::CalculatorBase& serenityCalculator(Scine::Core::Calculator& calculator) {
+  auto* serenity = dynamic_cast<Scine::Serenity::CalculatorBase*>(&calculator);
+  if (!serenity) {
+    throw std::invalid_argument("The calculator '" + calculator.name() + "' is not a Serenity calculator.");
+  }
+  return *serenity;
+}
+} // namespace
+
+PYBIND11_MODULE(_serenity, m) {
+  // The calculator and property types are registered by the utilities
+  py::module::import("scine_utilities");
+  m.doc() = "Functionality of the Serenity calculators beyond the common calculator interface.";
+
+  m.def(
+      "calculate_batch",
+      [](Scine::Core::Calculator& calculator, const std::vector<Scine::Utils::PositionCollection>& positions) {
+        auto& serenity = serenityCalculator(calculator);
+        py::gil_scoped_release release;
+        return serenity.calculateBatch(positions);
+      },
+      py::arg("calculator"), py::arg("positions"),
+      R"delim(
+      Calculates the required properties of the calculator for many sets of positions
+      of its current structure.
+
+      The geometries are visited in nearest-neighbour order, such that each converged
+      electronic structure can serve as initial guess for the closest remaining geometry,
+      and the underlying system is set up only once. Failed calculations do not abort the
+      batch; the corresponding results have ``successful_calculation`` set to ``False``
+      and the error message as ``description``. The geometries are calculated one after
+      the other in this process, ``displacement_workers`` does not apply to batches. The
+      positions of the calculator are restored afterwards, which leaves its ``results()``
+      empty. The GIL is released meanwhile.
+
+      :param calculator: A Serenity calculator with a structure assigned.
+      :param positions: A list of position arrays (bohr), each in the atom order of the structure.
+      :return: A list of results in the order of the given positions.
+    )delim");
+
+  m.def(
+      "screened_matrix",
+      [](Scine::Core::Calculator& calculator, Scine::Utils::Property property, const std::string& spin) {
+        return serenityCalculator(calculator).getScreenedMatrix(property, spin).matrix;
+      },
+      py::arg("calculator"), py::arg("property"), py::arg("spin") = "total",
+      R"delim(
+      The screened form of a matrix property of the last calculation.
+
+      With ``sparse_matrix_threshold`` > 0, the required density (the total density and, if
+      unrestricted, the alpha and beta densities) and overlap matrices are replaced by their
+      screened forms, which are only available through this function. The results then lack
+      these required properties.
+
+      :param calculator: A Serenity calculator.
+      :param property: Either ``Property.DensityMatrix`` or ``Property.OverlapMatrix``.
+      :param spin: ``total``, or ``alpha`` or ``beta`` for unrestricted density matrices.
+      :return: The matrix as ``scipy.sparse.csr_matrix``.
+    )delim");
+
+  m.def(
+      "setting_categories",
+      [](Scine::Core::Calculator& calculator) { return serenityCalculator(calculator).settingCategories(); },
+      py::arg("calculator"),
+      R"delim(
+      The categories each setting of the calculator is declared in.
+
+      Changing a ``technical`` setting invalidates nothing, ``convergence`` settings keep the
+      system, and ``charges``, ``gradients``, ``thermochemistry`` and ``correlation`` settings
+      only invalidate the corresponding results. All other settings define the ``system``.
+
+      :param calculator: A Serenity calculator.
+      :return: A dictionary of the list of categories of each setting.
+    )delim");
+}
@@ -3,6 +3,8 @@ Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Gr
 See LICENSE.txt for details.
 """
 
+import os
+import tempfile
 import pytest
 import scine_utilities as utils
 
@@ -36,7 +38,7 @@ def test_dft_restricted_other_properties() -> None:
     calculator.settings['basis_set'] = 'def2-tzvp'
     calculator.set_required_properties([utils.Property.AOtoAtomMapping,
                                         utils.Property.AtomicCharges,
-                                        # utils.Property.OneElectronMatrix,
+                                        utils.Property.OneElectronMatrix,
                                         utils.Property.OverlapMatrix,
                                         utils.Property.Thermochemistry,
                                         utils.Property.Gradients])
@@ -48,27 +50,26 @@ def test_dft_restricted_other_properties() -> None:
     assert results.ao_to_atom_mapping is not None
     assert results.atomic_charges is not None
     assert results.overlap_matrix is not None
-    # assert results.one_electron_matrix is not None
-
-# TODO This should be included again as soon as the serenity wrapper avoids running SCF calculations for everything.
-# def test_dft_restricted_non_scf_properties() -> None:
-#     h2 = create_h2()
-#     module_manager = utils.core.ModuleManager.get_instance()
-#     calculator = module_manager.get('calculator', 'dft')
-#     assert calculator.name() == 'SerenityDFTCalculator'
-#     calculator.structure = h2
-#     calculator.settings['method'] = 'pbe-d3bj'
-#     calculator.settings['basis_set'] = 'def2-tzvp'
-#     calculator.set_required_properties([utils.Property.AOtoAtomMapping,
-#                                         utils.Property.OneElectronMatrix,
-#                                         utils.Property.OverlapMatrix,
-#                                         ])
-#     results = calculator.calculate()
-#     assert results.successful_calculation
-#     assert results.ao_to_atom_mapping is not None
-#     assert results.overlap_matrix is not None
-#     assert results.one_electron_matrix is not None
-#     assert results.energy is None
+    assert results.one_electron_matrix is not None
+
+def test_dft_restricted_non_scf_properties() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'dft')
+    assert calculator.name() == 'SerenityDFTCalculator'
+    calculator.structure = h2
+    calculator.settings['method'] = 'pbe-d3bj'
+    calculator.settings['basis_set'] = 'def2-tzvp'
+    calculator.set_required_properties([utils.Property.AOtoAtomMapping,
+                                        utils.Property.OneElectronMatrix,
+                                        utils.Property.OverlapMatrix,
+                                        ])
+    results = calculator.calculate()
+    assert results.successful_calculation
+    assert results.ao_to_atom_mapping is not None
+    assert results.overlap_matrix is not None
+    assert results.one_electron_matrix is not None
+    assert results.energy is None
 
 def test_dft_unrestricted() -> None:
     h2 = create_h2()
@@ -85,6 +86,421 @@ def test_dft_unrestricted() -> None:
     assert results.energy
     assert abs(results.energy - -1.166043) < 1e-6
 
+def test_hf_parallel_hessian() -> None:
+    import os
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    hessians = []
+    # NumericalHessianCalc, worker processes and the in-process fallback without a worker executable
+    for workers, executable in [(1, None), (3, None), (3, '/nonexistent/serenity_displacement_worker')]:
+        if executable is not None:
+            os.environ['SCINE_SERENITY_WORKER'] = executable
+        try:
+            calculator = module_manager.get('calculator', 'hf')
+            calculator.structure = h2
+            calculator.settings['method'] = 'hf'
+            calculator.settings['basis_set'] = 'def2-svp'
+            calculator.settings['self_consistence_criterion'] = 1e-10
+            calculator.settings['scf_rmsdThreshold'] = 1e-10
+            calculator.settings['displacement_workers'] = workers
+            calculator.settings['displacement_threads_per_worker'] = 1
+            calculator.set_required_properties([utils.Property.Energy, utils.Property.Hessian])
+            results = calculator.calculate()
+            assert results.successful_calculation
+            # The thermochemistry comes with the Hessian
+            assert results.thermochemistry is not None
+            hessians.append(results.hessian)
+        finally:
+            os.environ.pop('SCINE_SERENITY_WORKER', None)
+    for hessian in hessians[1:]:
+        assert hessian.shape == hessians[0].shape
+        assert abs(hessian - hessians[0]).max() < 1e-6
+
+def test_dft_batch() -> None:
+    import scine_serenity_wrapper
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'dft')
+    calculator.structure = h2
+    calculator.settings['method'] = 'pbe'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.set_required_properties([utils.Property.Energy])
+    positions = [
+        [[-0.75, 0.0, 0.0], [0.75, 0.0, 0.0]],
+        [[-0.7, 0.0, 0.0], [0.7, 0.0, 0.0], [0.0, 2.0, 0.0]],
+        [[-0.65, 0.0, 0.0], [0.65, 0.0, 0.0]],
+    ]
+    batch = scine_serenity_wrapper.calculate_batch(calculator, positions)
+    assert len(batch) == 3
+    assert not batch[1].successful_calculation
+    for i in [0, 2]:
+        assert batch[i].successful_calculation
+        single = calculator.clone()
+        single.structure = utils.AtomCollection(h2.elements, positions[i])
+        assert abs(batch[i].energy - single.calculate().energy) < 1e-6
+    assert abs(calculator.positions - h2.positions).max() < 1e-12
+
+def test_dft_warm_clone() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'dft')
+    calculator.structure = h2
+    calculator.settings['method'] = 'pbe'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.settings['warm_clone'] = True
+    calculator.set_required_properties([utils.Property.Energy])
+    energy = calculator.calculate().energy
+    clone = calculator.clone()
+    assert abs(clone.calculate().energy - energy) < 1e-6
+    # Moving the clone must not move the original
+    clone.positions = [[-0.75, 0.0, 0.0], [0.75, 0.0, 0.0]]
+    assert abs(clone.calculate().energy - energy) > 1e-4
+    assert abs(calculator.positions - h2.positions).max() < 1e-12
+    assert abs(calculator.calculate().energy - energy) < 1e-6
+
+def test_dft_state_spilling() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'dft')
+    calculator.structure = h2
+    calculator.settings['method'] = 'pbe'
+    calculator.settings['basis_set'] = 'def2-svp'
+    # All states are written to disk
+    calculator.settings['state_memory_limit'] = 0.0
+    calculator.set_required_properties([utils.Property.Energy])
+    energies = []
+    states = []
+    for distance in [0.7, 0.75, 0.8]:
+        calculator.positions = [[-distance, 0.0, 0.0], [distance, 0.0, 0.0]]
+        energies.append(calculator.calculate().energy)
+        states.append(calculator.get_state())
+    # Spilled states restore their geometry and orbitals
+    for energy, state in zip(energies, states):
+        calculator.load_state(state)
+        assert abs(calculator.calculate().energy - energy) < 1e-6
+
+def test_dft_guess_extrapolation() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'dft')
+    calculator.structure = h2
+    calculator.settings['method'] = 'pbe'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.settings['guess_extrapolation'] = 'aspc'
+    calculator.set_required_properties([utils.Property.Energy])
+    results = calculator.calculate()
+    assert 'scf_guess=initial' in results.description
+    for step in range(1, 5):
+        calculator.positions = h2.positions * (1.0 + 0.01 * step)
+        results = calculator.calculate()
+        assert results.successful_calculation
+    assert 'scf_guess=aspc' in results.description
+    reference = module_manager.get('calculator', 'dft')
+    reference.structure = utils.AtomCollection(h2.elements, calculator.positions)
+    reference.settings['method'] = 'pbe'
+    reference.settings['basis_set'] = 'def2-svp'
+    reference.set_required_properties([utils.Property.Energy])
+    assert abs(reference.calculate().energy - results.energy) < 1e-6
+
+def test_dft_guess_cache() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    with tempfile.TemporaryDirectory() as cache:
+        energies = []
+        for expected in ['miss', 'exact']:
+            calculator = module_manager.get('calculator', 'dft')
+            calculator.structure = h2
+            calculator.settings['method'] = 'pbe'
+            calculator.settings['basis_set'] = 'def2-svp'
+            calculator.settings['guess_cache_directory'] = cache
+            calculator.set_required_properties([utils.Property.Energy])
+            results = calculator.calculate()
+            assert 'guess_cache=' + expected in results.description
+            energies.append(results.energy)
+        assert abs(energies[0] - energies[1]) < 1e-6
+        # Nearby geometries are found through the index of the group
+        calculator = module_manager.get('calculator', 'dft')
+        calculator.structure = h2
+        calculator.settings['method'] = 'pbe'
+        calculator.settings['basis_set'] = 'def2-svp'
+        calculator.settings['guess_cache_directory'] = cache
+        positions = h2.positions
+        positions[0][0] -= 0.02
+        calculator.positions = positions
+        calculator.set_required_properties([utils.Property.Energy])
+        assert 'guess_cache=nearby' in calculator.calculate().description
+        # Entries belong to the reference method, MP2 and CC share the HF orbitals
+        for name, expected in [('mp2', 'miss'), ('cc', 'exact')]:
+            calculator = module_manager.get('calculator', name)
+            calculator.structure = h2
+            calculator.settings['basis_set'] = 'def2-svp'
+            calculator.settings['guess_cache_directory'] = cache
+            calculator.set_required_properties([utils.Property.Energy])
+            assert 'guess_cache=' + expected in calculator.calculate().description
+
+def test_dft_scratch_cleanup() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'dft')
+    with tempfile.TemporaryDirectory() as scratch:
+        calculator.settings['method'] = 'pbe'
+        calculator.settings['basis_set'] = 'def2-svp'
+        calculator.settings['scratch_directory'] = scratch
+        calculator.structure = h2
+        calculator.set_required_properties([utils.Property.Energy])
+        assert calculator.calculate().successful_calculation
+        assert len(os.listdir(scratch)) == 1
+        # A new structure releases the files of the previous system
+        calculator.structure = h2
+        assert not os.listdir(scratch)
+
+def test_dft_stale_ram_scratch() -> None:
+    import subprocess
+    import sys
+    if not os.path.isdir('/dev/shm'):
+        pytest.skip('No RAM-backed scratch directories on this platform.')
+    # The RAM root of a process that is gone
+    finished = subprocess.Popen([sys.executable, '-c', ''])
+    finished.wait()
+    stale = os.path.join('/dev/shm', 'serenity_' + str(finished.pid))
+    os.makedirs(os.path.join(stale, 'leftover'), exist_ok=True)
+    # The scratch manager is set up once per process, hence a fresh one
+    script = '\n'.join([
+        'import scine_utilities as utils',
+        'import scine_serenity_wrapper',
+        'calculator = utils.core.ModuleManager.get_instance().get("calculator", "dft")',
+        'calculator.structure = utils.AtomCollection([utils.ElementType.H] * 2, [[-0.7, 0, 0], [0.7, 0, 0]])',
+        'calculator.settings["method"] = "pbe"',
+        'calculator.settings["basis_set"] = "def2-svp"',
+        'calculator.settings["scratch_memory_limit"] = 100.0',
+        'assert calculator.calculate().successful_calculation',
+    ])
+    subprocess.run([sys.executable, '-c', script], check=True)
+    assert not os.path.exists(stale)
+
+def test_dft_property_reuse() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'dft')
+    calculator.structure = h2
+    calculator.settings['method'] = 'pbe'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.Gradients])
+    first = calculator.calculate()
+    assert 'recomputed=scf,gradients' in first.description
+    # The same geometry reuses everything and only adds what is missing
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.Gradients,
+                                        utils.Property.DensityMatrix])
+    second = calculator.calculate()
+    assert 'recomputed=density_exports' in second.description
+    assert 'reused=scf,gradients' in second.description
+    assert abs(first.energy - second.energy) < 1e-12
+    assert second.density_matrix is not None
+    # A different method requires a new system
+    calculator.settings['method'] = 'b3lyp'
+    third = calculator.calculate()
+    assert 'reused=none' in third.description
+    assert abs(first.energy - third.energy) > 1e-6
+
+def test_threaded_calculations() -> None:
+    from concurrent.futures import ThreadPoolExecutor
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+
+    def run(method_family: str, method: str, show_output: bool) -> float:
+        calculator = module_manager.get('calculator', method_family)
+        calculator.structure = h2
+        calculator.settings['method'] = method
+        calculator.settings['basis_set'] = 'def2-svp'
+        calculator.settings['show_serenity_output'] = show_output
+        calculator.set_required_properties([utils.Property.Energy, utils.Property.Gradients])
+        results = calculator.calculate()
+        assert results.successful_calculation
+        return results.energy
+
+    jobs = [('dft', 'pbe', False), ('hf', 'hf', True), ('dft', 'b3lyp', False), ('hf', 'hf', False)] * 2
+    serial = [run(*job) for job in jobs]
+    with ThreadPoolExecutor(max_workers=4) as executor:
+        threaded = list(executor.map(lambda job: run(*job), jobs))
+    for reference, energy in zip(serial, threaded):
+        assert abs(reference - energy) < 1e-8
+
+def test_async_calculations() -> None:
+    import asyncio
+    import scine_serenity_wrapper
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculators = []
+    for method in ['pbe', 'b3lyp', 'pbe0']:
+        calculator = module_manager.get('calculator', 'dft')
+        calculator.structure = h2
+        calculator.settings['method'] = method
+        calculator.settings['basis_set'] = 'def2-svp'
+        calculator.set_required_properties([utils.Property.Energy])
+        calculators.append(calculator)
+    futures = [scine_serenity_wrapper.calculate_async(c) for c in calculators]
+    # The last job is still queued behind the first one
+    assert futures[-1].cancel()
+    energies = [f.result().energy for f in futures[:-1]]
+    assert futures[-1].cancelled()
+    for calculator, energy in zip(calculators, energies):
+        assert abs(calculator.calculate().energy - energy) < 1e-8
+
+    async def gather():
+        return await asyncio.gather(*[scine_serenity_wrapper.calculate_awaitable(c) for c in calculators])
+    results = asyncio.run(gather())
+    assert all(r.successful_calculation for r in results)
+
+def test_dft_charge_models() -> None:
+    water = utils.AtomCollection(
+        [utils.ElementType.O, utils.ElementType.H, utils.ElementType.H],
+        [[0.0, 0.0, 0.0], [1.43, 1.11, 0.0], [-1.43, 1.11, 0.0]]
+    )
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'dft')
+    calculator.structure = water
+    calculator.settings['method'] = 'pbe'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.AtomicCharges])
+    charges = {}
+    for model in ['mulliken', 'hirshfeld', 'cm5']:
+        calculator.settings['atomic_charge_model'] = model
+        results = calculator.calculate()
+        if model != 'mulliken':
+            assert 'reused=scf' in results.description
+        charges[model] = results.atomic_charges
+        assert abs(sum(charges[model])) < 1e-3
+        assert charges[model][0] < 0.0
+    # CM5 makes the O-H bonds more polar than Hirshfeld
+    assert charges['cm5'][0] < charges['hirshfeld'][0]
+
+def test_hf_ri_approximations() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'hf')
+    calculator.structure = h2
+    calculator.settings['method'] = 'hf'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.Gradients])
+    results = {}
+    for approximation in ['none', 'rij', 'rijk']:
+        calculator.settings['ri_approximation'] = approximation
+        results[approximation] = calculator.calculate()
+        assert results[approximation].successful_calculation
+    for approximation in ['rij', 'rijk']:
+        assert abs(results[approximation].energy - results['none'].energy) < 1e-3
+        assert abs(results[approximation].gradients - results['none'].gradients).max() < 1e-3
+
+def test_dft_adaptive_grid() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'dft')
+    calculator.structure = h2
+    calculator.settings['method'] = 'pbe'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.settings['adaptive_grid'] = True
+    calculator.settings['adaptive_grid_gradient_threshold'] = 1e-6
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.Gradients])
+    results = calculator.calculate()
+    assert 'grid=small' in results.description
+    # Far from converged, the grid stays small
+    positions = h2.positions
+    positions[1][0] += 0.2
+    calculator.positions = positions
+    assert 'grid=small' in calculator.calculate().description
+    # Gradients below the threshold switch to the final grid, also for the same geometry
+    calculator.settings['adaptive_grid_gradient_threshold'] = 10.0
+    results = calculator.calculate()
+    assert 'grid=final' in results.description
+    assert 'recomputed=scf,gradients' in results.description
+
+def test_dft_adaptive_scf_threshold() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'dft')
+    calculator.structure = h2
+    calculator.settings['method'] = 'pbe'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.settings['self_consistence_criterion'] = 1e-8
+    calculator.settings['adaptive_scf_threshold'] = True
+    calculator.settings['adaptive_scf_factor'] = 1e3
+    calculator.settings['result_cache_size'] = 2
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.Gradients])
+    # Without previous gradients the requested threshold is used
+    assert 'scf_threshold=1.0e-08' in calculator.calculate().description
+    positions = h2.positions
+    positions[1][0] += 0.2
+    calculator.positions = positions
+    results = calculator.calculate()
+    assert 'scf_threshold=1.0e-05' in results.description
+    # Loosely converged results are neither reused nor cached
+    repeated = calculator.calculate()
+    assert 'recomputed=scf,gradients' in repeated.description
+    assert 'result_cache=miss' in repeated.description
+    reference = module_manager.get('calculator', 'dft')
+    reference.structure = calculator.structure
+    reference.settings['method'] = 'pbe'
+    reference.settings['basis_set'] = 'def2-svp'
+    reference.set_required_properties([utils.Property.Energy])
+    assert abs(results.energy - reference.calculate().energy) < 1e-4
+    # Hessians differentiate the gradients, they use the requested threshold
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.Hessian])
+    assert 'scf_threshold=1.0e-08' in calculator.calculate().description
+
+def test_dft_result_cache() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'dft')
+    calculator.structure = h2
+    calculator.settings['method'] = 'pbe'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.settings['result_cache_size'] = 8
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.Gradients])
+    first = calculator.calculate()
+    assert 'result_cache=miss' in first.description
+    energy = first.energy
+    gradients = first.gradients
+    displaced = h2.positions
+    displaced[1][0] += 0.1
+    calculator.positions = displaced
+    assert 'result_cache=miss' in calculator.calculate().description
+    # Revisiting a geometry returns the cached properties without an SCF
+    calculator.positions = h2.positions
+    calculator.set_required_properties([utils.Property.Energy])
+    results = calculator.calculate()
+    assert 'result_cache=hit' in results.description
+    assert 'recomputed=none' in results.description
+    assert results.energy == energy
+    # The orbitals belong to the displaced geometry, states then hold none
+    calculator.load_state(calculator.get_state())
+    assert abs(calculator.positions - h2.positions).max() < 1e-12
+    # Only missing properties are calculated
+    calculator.positions = displaced
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.Gradients,
+                                        utils.Property.AtomicCharges])
+    results = calculator.calculate()
+    assert 'result_cache=partial' in results.description
+    assert 'recomputed=scf,atomic_charges' in results.description
+    assert 'reused=gradients' in results.description
+    # Settings affecting results are part of the key
+    calculator.positions = h2.positions
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.Gradients])
+    calculator.settings['method'] = 'b3lyp'
+    assert 'result_cache=miss' in calculator.calculate().description
+    calculator.settings['method'] = 'pbe'
+    results = calculator.calculate()
+    assert 'result_cache=hit' in results.description
+    assert abs(results.gradients - gradients).max() == 0.0
+    # A cache size of zero clears the cache
+    calculator.settings['result_cache_size'] = 0
+    calculator.positions = displaced
+    results = calculator.calculate()
+    assert 'result_cache' not in results.description
+    assert 'recomputed=scf,gradients' in results.description
+    calculator.settings['result_cache_size'] = 8
+    calculator.positions = h2.positions
+    assert 'result_cache=miss' in calculator.calculate().description
+
 def test_hf_restricted() -> None:
     h2 = create_h2()
     module_manager = utils.core.ModuleManager.get_instance()
@@ -128,6 +544,72 @@ def test_ccsd_t_restricted() -> None:
     assert results.energy
     assert abs(results.energy - -1.168261) < 1e-6
 
+def test_ccsd_t_numerical_gradients() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    gradients = []
+    for workers in [1, 2]:
+        calculator = module_manager.get('calculator', 'cc')
+        calculator.structure = h2
+        calculator.settings['method'] = 'ccsd(t)'
+        calculator.settings['basis_set'] = 'def2-svp'
+        calculator.settings['self_consistence_criterion'] = 1e-9
+        calculator.settings['displacement_workers'] = workers
+        calculator.set_required_properties([utils.Property.Energy, utils.Property.Gradients])
+        results = calculator.calculate()
+        assert results.successful_calculation
+        gradients.append(results.gradients)
+    assert abs(gradients[0] - gradients[1]).max() < 1e-7
+    # Symmetric bond stretch along x
+    assert abs(gradients[0][0][0] + gradients[0][1][0]) < 1e-6
+    assert abs(gradients[0][:, 1:]).max() < 1e-6
+    # Compare to the finite difference of the bond length
+    step = 1e-3
+    energies = []
+    for sign in [1, -1]:
+        single = module_manager.get('calculator', 'cc')
+        single.structure = utils.AtomCollection(h2.elements, [[-0.7, 0.0, 0.0], [0.7 + sign * step, 0.0, 0.0]])
+        single.settings['method'] = 'ccsd(t)'
+        single.settings['basis_set'] = 'def2-svp'
+        single.settings['self_consistence_criterion'] = 1e-9
+        single.set_required_properties([utils.Property.Energy])
+        energies.append(single.calculate().energy)
+    assert abs(gradients[0][1][0] - (energies[0] - energies[1]) / (2 * step)) < 1e-4
+
+def test_cc_level_change_reuses_reference() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'cc')
+    calculator.structure = h2
+    calculator.settings['method'] = 'ccsd(t)'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.set_required_properties([utils.Property.Energy])
+    results = calculator.calculate()
+    assert 'cc_reference=computed' in results.description
+    assert 'cc_localization=computed' in results.description
+    triples = results.energy
+    # Only the correlation step is rerun for another level
+    calculator.settings['method'] = 'ccsd'
+    results = calculator.calculate()
+    assert 'recomputed=scf' in results.description
+    assert 'cc_reference=reused' in results.description
+    assert 'cc_localization=none' in results.description
+    assert 'correlation_time=' in results.description
+    reference = module_manager.get('calculator', 'cc')
+    reference.structure = h2
+    reference.settings['method'] = 'ccsd'
+    reference.settings['basis_set'] = 'def2-svp'
+    reference.set_required_properties([utils.Property.Energy])
+    assert abs(results.energy - reference.calculate().energy) < 1e-8
+    calculator.settings['method'] = 'ccsd(t)'
+    results = calculator.calculate()
+    assert 'cc_reference=reused' in results.description
+    assert 'cc_localization=reused' in results.description
+    assert abs(results.energy - triples) < 1e-8
+    # A new geometry needs a new reference
+    calculator.positions = [[-0.75, 0.0, 0.0], [0.75, 0.0, 0.0]]
+    assert 'cc_reference=computed' in calculator.calculate().description
+
 def test_dlpno_ccsd_t0_restricted() -> None:
     h2 = create_h2()
     module_manager = utils.core.ModuleManager.get_instance()
@@ -142,11 +624,240 @@ def test_dlpno_ccsd_t0_restricted() -> None:
     assert results.energy
     assert abs(results.energy - -1.168311) < 1e-6
 
+def test_dlpno_accuracy_presets() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    canonical = module_manager.get('calculator', 'cc')
+    canonical.structure = h2
+    canonical.settings['method'] = 'ccsd(t)'
+    canonical.settings['basis_set'] = 'def2-svp'
+    canonical.set_required_properties([utils.Property.Energy])
+    reference = canonical.calculate().energy
+    calculator = module_manager.get('calculator', 'cc')
+    calculator.structure = h2
+    calculator.settings['method'] = 'dlpno-ccsd(t0)'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.set_required_properties([utils.Property.Energy])
+    errors = {}
+    for accuracy in ['loose', 'normal', 'tight']:
+        calculator.settings['dlpno_accuracy'] = accuracy
+        results = calculator.calculate()
+        assert results.successful_calculation
+        errors[accuracy] = abs(results.energy - reference)
+    # Only the correlation step is rerun for other thresholds
+    assert 'cc_reference=reused' in results.description
+    assert errors['tight'] <= errors['loose'] + 1e-8
+    assert errors['tight'] < 1e-3
+    # Explicit thresholds replace the preset values
+    calculator.settings['dlpno_pno_threshold'] = 1e-12
+    assert abs(calculator.calculate().energy - reference) <= errors['tight'] + 1e-6
+    # Only the correlated calculators offer the DLPNO settings
+    assert 'dlpno_accuracy' not in module_manager.get('calculator', 'dft').settings
+    assert 'numerical_gradient_step' not in module_manager.get('calculator', 'hf').settings
+
+def test_fde_embedding() -> None:
+    h2_dimer = utils.AtomCollection(
+        [utils.ElementType.H] * 4,
+        [[-0.7, 0.0, 0.0], [0.7, 0.0, 0.0], [-0.7, 0.0, 5.0], [0.7, 0.0, 5.0]]
+    )
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'fde')
+    assert calculator.name() == 'SerenityEmbeddingCalculator'
+    calculator.structure = h2_dimer
+    calculator.settings['method'] = 'pbe'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.settings['embedding_active_atoms'] = '0-1'
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.Gradients])
+    results = calculator.calculate()
+    assert results.successful_calculation
+    assert results.gradients.shape == (4, 3)
+    relaxed = results.energy
+    # Two well separated molecules: the embedding energy is close to the full system
+    reference = module_manager.get('calculator', 'dft')
+    reference.structure = h2_dimer
+    reference.settings['method'] = 'pbe'
+    reference.settings['basis_set'] = 'def2-svp'
+    reference.set_required_properties([utils.Property.Energy])
+    assert abs(relaxed - reference.calculate().energy) < 1e-3
+    assert 'embedding_mode' not in reference.settings
+    # A frozen environment offers no gradients
+    calculator.settings['embedding_mode'] = 'frozen_environment'
+    with pytest.raises(RuntimeError):
+        calculator.calculate()
+    calculator.set_required_properties([utils.Property.Energy])
+    frozen = calculator.calculate().energy
+    assert abs(frozen - relaxed) < 1e-4
+    # Moving only active atoms keeps the environment density
+    positions = h2_dimer.positions
+    positions[0][0] -= 0.05
+    calculator.positions = positions
+    results = calculator.calculate()
+    assert results.successful_calculation
+    assert 'embedding_environment=reused' in results.description
+    calculator.settings['embedding_mode'] = 'freeze_and_thaw'
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.Gradients])
+    results = calculator.calculate()
+    assert results.successful_calculation
+    assert results.gradients[0][0] > 1e-3
+    # A new structure of the same elements keeps the subsystems
+    calculator.structure = h2_dimer
+    results = calculator.calculate()
+    assert 'embedding_environment=reused' in results.description
+    # The unpaired electrons of the environment belong to those of the whole system
+    calculator.settings['embedding_environment_charge'] = 1
+    calculator.settings['embedding_environment_spin_multiplicity'] = 2
+    with pytest.raises(RuntimeError):
+        calculator.calculate()
+
+def test_mp2_variants() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'mp2')
+    assert calculator.name() == 'SerenityMP2Calculator'
+    assert calculator.settings['method'] == 'ri-mp2'
+    calculator.structure = h2
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.Gradients])
+    results = calculator.calculate()
+    assert results.successful_calculation
+    canonical = results.energy
+    assert abs(results.gradients.sum(axis=0)).max() < 1e-4
+    # Other variants keep the HF reference
+    calculator.set_required_properties([utils.Property.Energy])
+    calculator.settings['method'] = 'dlpno-mp2'
+    results = calculator.calculate()
+    assert 'mp2_reference=reused' in results.description
+    assert abs(results.energy - canonical) < 1e-4
+    calculator.settings['method'] = 'sos-ri-mp2'
+    sos = calculator.calculate().energy
+    calculator.settings['method'] = 'ri-mp2'
+    calculator.settings['mp2_same_spin_scaling'] = 0.0
+    calculator.settings['mp2_opposite_spin_scaling'] = 1.3
+    assert abs(calculator.calculate().energy - sos) < 1e-10
+    # H2 has no same-spin pairs, SOS-MP2 only scales its opposite-spin correlation
+    assert sos < canonical
+    assert 'mp2_same_spin_scaling' not in module_manager.get('calculator', 'cc').settings
+
+def test_dft_reused_matrices() -> None:
+    h2 = create_h2()
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'dft')
+    calculator.structure = h2
+    calculator.settings['method'] = 'pbe'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.settings['result_cache_size'] = 8
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.DensityMatrix,
+                                        utils.Property.OverlapMatrix])
+    first = calculator.calculate()
+    density = first.density_matrix.restricted_matrix.copy()
+    overlap = first.overlap_matrix.copy()
+    # Carried over from the previous results, then served by the result cache
+    for _ in range(2):
+        results = calculator.calculate()
+        assert 'recomputed=none' in results.description
+        assert abs(results.density_matrix.restricted_matrix - density).max() == 0.0
+        assert abs(results.overlap_matrix - overlap).max() == 0.0
+    calculator.positions = h2.positions
+    results = calculator.calculate()
+    assert 'result_cache=hit' in results.description
+    assert abs(results.density_matrix.restricted_matrix - density).max() == 0.0
+    assert abs(results.overlap_matrix - overlap).max() == 0.0
+
+def test_dft_sparse_matrices() -> None:
+    separated = utils.AtomCollection(
+        [utils.ElementType.H] * 4,
+        [[-0.7, 0.0, 0.0], [0.7, 0.0, 0.0], [-0.7, 0.0, 30.0], [0.7, 0.0, 30.0]]
+    )
+    module_manager = utils.core.ModuleManager.get_instance()
+    calculator = module_manager.get('calculator', 'dft')
+    calculator.structure = separated
+    calculator.settings['method'] = 'pbe'
+    calculator.settings['basis_set'] = 'def2-svp'
+    calculator.set_required_properties([utils.Property.Energy, utils.Property.DensityMatrix,
+                                        utils.Property.OverlapMatrix, utils.Property.BondOrderMatrix])
+    results = calculator.calculate()
+    assert 'sparse_' not in results.description
+    calculator.settings['sparse_matrix_threshold'] = 1e-8
+    results = calculator.calculate()
+    assert results.successful_calculation
+    entries = dict(entry.split('=') for entry in results.description.split('; '))
+    # The blocks between the two molecules are discarded
+    for name in ['density', 'overlap']:
+        assert float(entries['sparse_' + name + '_retained']) <= 0.5 + 1e-9
+        assert float(entries['sparse_' + name + '_error']) < 1e-8
+    assert float(entries['sparse_bond_orders_error']) < 1e-8
+    # The dense matrices are replaced by their screened forms
+    import scine_serenity_wrapper
+    assert results.overlap_matrix is None
+    assert results.density_matrix is None
+    overlap = scine_serenity_wrapper.screened_matrix(calculator, utils.Property.OverlapMatrix)
+    assert overlap.shape == (20, 20)
+    assert overlap.nnz <= 200
+    assert abs(overlap[0, 0] - 1.0) < 1e-10
+    density = scine_serenity_wrapper.screened_matrix(calculator, utils.Property.DensityMatrix)
+    assert density.shape == (20, 20)
+    with pytest.raises(RuntimeError):
+        scine_serenity_wrapper.screened_matrix(calculator, utils.Property.BondOrderMatrix)
+    # Result cache hits hold the dense matrices and are screened again
+    calculator.settings['result_cache_size'] = 2
+    calculator.calculate()
+    results = calculator.calculate()
+    assert 'result_cache=hit' in results.description
+    assert results.density_matrix is None
+    assert (scine_serenity_wrapper.screened_matrix(calculator, utils.Property.DensityMatrix) != density).nnz == 0
+    # Unrestricted densities keep their spin components
+    calculator.settings['spin_mode'] = 'unrestricted'
+    calculator.calculate()
+    alpha = scine_serenity_wrapper.screened_matrix(calculator, utils.Property.DensityMatrix, 'alpha')
+    beta = scine_serenity_wrapper.screened_matrix(calculator, utils.Property.DensityMatrix, 'beta')
+    total = scine_serenity_wrapper.screened_matrix(calculator, utils.Property.DensityMatrix)
+    assert abs(alpha + beta - total).max() < 1e-10
+
+def test_setting_categories() -> None:
+    import scine_serenity_wrapper
+    module_manager = utils.core.ModuleManager.get_instance()
+    for name in ['dft', 'hf', 'cc', 'mp2', 'fde']:
+        calculator = module_manager.get('calculator', name)
+        categories = scine_serenity_wrapper.setting_categories(calculator)
+        # Every setting belongs to exactly one category, no category declares unknown settings
+        assert set(categories.keys()) == set(calculator.settings.keys())
+        for key, declared in categories.items():
+            assert len(declared) == 1, (name, key, declared)
+    cc = scine_serenity_wrapper.setting_categories(module_manager.get('calculator', 'cc'))
+    assert cc['method'] == ['correlation']
+    assert cc['numerical_gradient_step'] == ['gradients']
+    assert scine_serenity_wrapper.setting_categories(module_manager.get('calculator', 'dft'))['method'] == ['system']
+
 def run_all_tests() -> None:
     test_dft_restricted()
     test_dft_unrestricted()
     test_dft_restricted_other_properties()
+    test_dft_restricted_non_scf_properties()
+    test_hf_parallel_hessian()
+    test_dft_batch()
+    test_dft_warm_clone()
+    test_dft_state_spilling()
+    test_dft_guess_extrapolation()
+    test_dft_guess_cache()
+    test_dft_scratch_cleanup()
+    test_dft_stale_ram_scratch()
+    test_dft_property_reuse()
+    test_threaded_calculations()
+    test_async_calculations()
+    test_dft_charge_models()
+    test_hf_ri_approximations()
+    test_dft_adaptive_grid()
+    test_dft_adaptive_scf_threshold()
+    test_dft_result_cache()
     test_hf_restricted()
     test_hf_unrestricted()
     test_ccsd_t_restricted()
-    test_dlpno_ccsd_t0_restricted()
\ No newline at end of file
+    test_ccsd_t_numerical_gradients()
+    test_cc_level_change_reuses_reference()
+    test_dlpno_ccsd_t0_restricted()
+    test_dlpno_accuracy_presets()
+    test_fde_embedding()
+    test_mp2_variants()
+    test_dft_reused_matrices()
+    test_dft_sparse_matrices()
+    test_setting_categories()
\ No newline at end of file
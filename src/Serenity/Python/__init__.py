@@ -21,3 +21,49 @@ if not manager.module_loaded('Serenity'):
             raise ImportError('The serenity.module.so was found but could not be loaded.')
     else:
         raise ImportError('The serenity.module.so could not be located.')
+
+from scine_serenity_wrapper._serenity import (  # noqa: E402 pylint: disable=wrong-import-position
+    calculate_batch, screened_matrix, setting_categories
+)
+
+
+_executor = None
+
+
+def calculate_async(calculator, executor=None):
+    """
+    Wraps ``calculator.calculate`` into a ``concurrent.futures.Future``.
+
+    This is a futures wrapper, not a parallel executor: Serenity calculations within
+    one process run one after the other (each using all OpenMP threads), hence the
+    default executor has a single worker and further executor threads would only
+    wait. Serenity calculators allow the GIL to be released
+    (``allowsPythonGILRelease()``), so Python code keeps running while a calculation
+    is in progress. Use several processes for truly parallel calculations. The
+    calculator must not be modified until the future has completed.
+
+    :param calculator: A Serenity calculator with a structure assigned.
+    :param executor: A ``concurrent.futures.Executor``, by default a module-wide
+                     single-threaded one.
+    :return: A ``concurrent.futures.Future`` of the results; pending calculations can
+             be cancelled through ``Future.cancel()``.
+    """
+    global _executor  # pylint: disable=global-statement
+    if executor is None:
+        if _executor is None:
+            from concurrent.futures import ThreadPoolExecutor
+            _executor = ThreadPoolExecutor(max_workers=1, thread_name_prefix='serenity')
+        executor = _executor
+    return executor.submit(calculator.calculate)
+
+
+async def calculate_awaitable(calculator, executor=None):
+    """
+    Awaitable version of :func:`calculate_async` for use with ``asyncio``.
+
+    :param calculator: A Serenity calculator with a structure assigned.
+    :param executor: See :func:`calculate_async`.
+    :return: The results.
+    """
+    import asyncio
+    return await asyncio.wrap_future(calculate_async(calculator, executor))
@@ -0,0 +1,77 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+/* Wrapper Includes */
+#include "Serenity/Calculators/BlockScreening.h"
+/* External Includes */
+#include <algorithm>
+#include <cmath>
+
+namespace Scine {
+namespace Serenity {
+
+ScreenedMatrix BlockScreening::screen(const Eigen::MatrixXd& matrix,
+                                      const std::vector<std::pair<unsigned int, unsigned int>>& blocks,
+                                      double threshold) {
+  ScreenedMatrix screened;
+  screened.matrix.resize(matrix.rows(), matrix.cols());
+  if (matrix.size() == 0) {
+    return screened;
+  }
+  // Decides on all blocks first, such that the CSR storage is reserved once
+  const auto nBlocks = static_cast<unsigned int>(blocks.size());
+  std::vector<std::vector<unsigned int>> retained(nBlocks);
+  Eigen::Index nRetained = 0;
+  for (unsigned int i = 0; i < nBlocks; ++i) {
+    const unsigned int nRows = blocks[i].second - blocks[i].first;
+    for (unsigned int j = 0; j < nBlocks && nRows > 0; ++j) {
+      const unsigned int nColumns = blocks[j].second - blocks[j].first;
+      if (nColumns == 0) {
+        continue;
+      }
+      const double largest = matrix.block(blocks[i].first, blocks[j].first, nRows, nColumns).cwiseAbs().maxCoeff();
+      if (largest >= threshold) {
+        retained[i].push_back(j);
+        nRetained += static_cast<Eigen::Index>(nRows) * nColumns;
+      }
+      else {
+        screened.maxError = std::max(screened.maxError, largest);
+      }
+    }
+  }
+  screened.matrix.reserve(nRetained);
+  for (unsigned int i = 0; i < nBlocks; ++i) {
+    for (unsigned int row = blocks[i].first; row < blocks[i].second; ++row) {
+      screened.matrix.startVec(row);
+      for (const auto j : retained[i]) {
+        for (unsigned int column = blocks[j].first; column < blocks[j].second; ++column) {
+          screened.matrix.insertBack(row, column) = matrix(row, column);
+        }
+      }
+    }
+  }
+  screened.matrix.finalize();
+  screened.retainedFraction = static_cast<double>(nRetained) / static_cast<double>(matrix.size());
+  return screened;
+}
+
+ScreenedMatrix BlockScreening::screen(const Eigen::SparseMatrix<double>& matrix, double threshold) {
+  ScreenedMatrix screened;
+  screened.matrix = matrix;
+  screened.matrix.prune([&](Eigen::Index, Eigen::Index, double value) {
+    if (std::abs(value) >= threshold) {
+      return true;
+    }
+    screened.maxError = std::max(screened.maxError, std::abs(value));
+    return false;
+  });
+  const double size = static_cast<double>(matrix.rows()) * static_cast<double>(matrix.cols());
+  screened.retainedFraction = (size > 0.0) ? static_cast<double>(screened.matrix.nonZeros()) / size : 1.0;
+  return screened;
+}
+
+} /* namespace Serenity */
+} /* namespace Scine */
@@ -0,0 +1,62 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef SERENITY_BLOCKSCREENING_H_
+#define SERENITY_BLOCKSCREENING_H_
+
+/* External Includes */
+#include <Eigen/Dense>
+#include <Eigen/SparseCore>
+#include <utility>
+#include <vector>
+
+namespace Scine {
+namespace Serenity {
+
+/**
+ * @brief A matrix screened by a threshold, in compressed sparse row (CSR) form.
+ */
+struct ScreenedMatrix {
+  Eigen::SparseMatrix<double, Eigen::RowMajor> matrix;
+  /// @brief The fraction of the elements of the dense matrix that were retained.
+  double retainedFraction = 1.0;
+  /// @brief The largest absolute value of the discarded elements.
+  double maxError = 0.0;
+};
+
+/**
+ * @brief Screening of (AO) matrices by atom blocks.
+ *
+ * A block of the rows of one atom and the columns of another one is either retained as a whole
+ * or discarded as a whole, depending on its largest absolute element. All blocks are screened
+ * first, such that the CSR storage is reserved once; the retained ones are then written into
+ * it in order, without any intermediate (triplet) storage.
+ */
+class BlockScreening {
+ public:
+  /**
+   * @brief Screens a dense matrix.
+   * @param matrix    The matrix.
+   * @param blocks    The first and the past-the-end index of the basis functions of each atom,
+   *                  as given by getBasisIndices().
+   * @param threshold Blocks with all elements below this absolute value are discarded.
+   * @return ScreenedMatrix The screened matrix.
+   */
+  static ScreenedMatrix screen(const Eigen::MatrixXd& matrix,
+                               const std::vector<std::pair<unsigned int, unsigned int>>& blocks, double threshold);
+  /**
+   * @brief Screens a sparse matrix elementwise (e.g. bond orders, with one row per atom).
+   * @param matrix    The matrix.
+   * @param threshold Elements below this absolute value are discarded.
+   * @return ScreenedMatrix The screened matrix.
+   */
+  static ScreenedMatrix screen(const Eigen::SparseMatrix<double>& matrix, double threshold);
+};
+
+} /* namespace Serenity */
+} /* namespace Scine */
+
+#endif /* SERENITY_BLOCKSCREENING_H_ */
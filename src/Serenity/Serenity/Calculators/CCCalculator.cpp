@@ -7,97 +7,132 @@
 #include "Serenity/Calculators/CCCalculator.h"
 #include "Serenity/Calculators/ScineSettings.h"
 /* Serenity Includes */
-#include <basis/AtomCenteredBasisController.h>
 #include <data/ElectronicStructure.h>
-#include <data/matrices/DensityMatrix.h>
 #include <energies/EnergyContributions.h>
 #include <geometry/Geometry.h>
 #include <geometry/gradients/NumericalHessianCalc.h>
-#include <integrals/OneElectronIntegralController.h>
 #include <potentials/bundles/PotentialBundle.h>
 #include <settings/Settings.h>
 #include <system/SystemController.h>
 #include <tasks/CoupledClusterTask.h>
-#include <tasks/LocalizationTask.h>
 #include <tasks/ScfTask.h>
 /* Scine Includes */
-#include <Utils/CalculatorBasics/ResultsAutoCompleter.h>
-#include <Utils/DataStructures/AtomsOrbitalsIndexes.h>
 #include <Utils/Geometry.h>
-#include <Utils/Scf/LcaoUtils/ElectronicOccupation.h>
 #include <Utils/Technical/UniqueIdentifier.h>
 #include <Utils/Typenames.h>
+#include <Utils/UniversalSettings/SettingsNames.h>
+#include <algorithm>
+#include <chrono>
 
 namespace Sty = Serenity;
 
 namespace Scine {
 namespace Serenity {
 
+CCCalculator::CCCalculator() {
+  this->_settings = std::make_unique<ScineSettings>(std::vector<ScineSettings::Group>{
+      ScineSettings::Group::NumericalGradients, ScineSettings::Group::LocalCorrelation});
+}
+
 std::string CCCalculator::name() const {
   return "SerenityCCCalculator";
 }
 
 Scine::Utils::PropertyList CCCalculator::possibleProperties() const {
-  return Scine::Utils::Property::Energy | Scine::Utils::Property::AtomicCharges |
-         Scine::Utils::Property::OverlapMatrix | Scine::Utils::Property::AOtoAtomMapping;
+  return Scine::Utils::Property::Energy | Scine::Utils::Property::Gradients | Scine::Utils::Property::AtomicCharges |
+         Scine::Utils::Property::OverlapMatrix | Scine::Utils::Property::AOtoAtomMapping |
+         Scine::Utils::Property::OneElectronMatrix;
 }
 
 void CCCalculator::applyFixedSettings(Sty::Settings& settings) const {
   settings.method = Sty::Options::ELECTRONIC_STRUCTURE_THEORIES::HF;
 }
 
-template<Sty::Options::SCF_MODES ScfMode>
-void CCCalculator::calculateImpl() {
-  if (ScfMode == Sty::Options::SCF_MODES::UNRESTRICTED)
-    throw std::runtime_error("Unrestricted Coupled Cluster calculations are not yet supported in Serenity.");
-  // Calculate energy and electronic structure
+Sty::Options::CC_LEVEL CCCalculator::level() const {
   Sty::Options::CC_LEVEL level = Sty::Options::CC_LEVEL::DLPNO_CCSD_T0;
   auto method = this->_settings->getString("method");
   Sty::Options::resolve(method, level);
-  if (this->_moved) {
-    Sty::ScfTask<ScfMode> scf(_system);
-    scf.run();
-    if (level == Sty::Options::CC_LEVEL::DLPNO_CCSD_T0 || level == Sty::Options::CC_LEVEL::CCSD_T) {
-      Sty::LocalizationTask loc(_system);
-      loc.settings.locType = Sty::Options::ORBITAL_LOCALIZATION_ALGORITHMS::IBO;
-      loc.run();
-    }
-    Sty::CoupledClusterTask cc(_system);
-    cc.settings.level = level;
-    cc.run();
-    this->_moved = false;
-    _results->set<Scine::Utils::Property::SuccessfulCalculation>(true);
-  }
-  auto es = _system->getElectronicStructure<ScfMode>();
-  const double hf = es->getEnergy(Sty::ENERGY_CONTRIBUTIONS::HF_ENERGY);
+  return level;
+}
+
+std::set<std::string> CCCalculator::correlationKeys() const {
+  auto keys = localCorrelationKeys();
+  keys.insert(Scine::Utils::SettingsNames::method);
+  return keys;
+}
+
+std::set<std::string> CCCalculator::gradientKeys() const {
+  return {"numerical_gradient_step"};
+}
+
+bool CCCalculator::needsLocalization(Sty::Options::CC_LEVEL level) {
+  return level == Sty::Options::CC_LEVEL::DLPNO_CCSD_T0 || level == Sty::Options::CC_LEVEL::CCSD_T;
+}
+
+template<Sty::Options::SCF_MODES ScfMode>
+double CCCalculator::correlationEnergy(const std::shared_ptr<Sty::SystemController>& system,
+                                       Sty::Options::CC_LEVEL level) const {
+  Sty::CoupledClusterTask cc(system);
+  cc.settings.level = level;
+  this->applyLocalCorrelationSettings(cc.settings.lcSettings);
+  cc.run();
+  auto es = system->getElectronicStructure<ScfMode>();
   const double sd = es->getEnergy(Sty::ENERGY_CONTRIBUTIONS::CCSD_CORRECTION);
-  double t = 0.0;
-  if (level == Sty::Options::CC_LEVEL::DLPNO_CCSD_T0 || level == Sty::Options::CC_LEVEL::CCSD_T) {
-    t = es->getEnergy(Sty::ENERGY_CONTRIBUTIONS::TRIPLES_CORRECTION);
-  }
-  const double total = hf + sd + t;
-  _results->set<Scine::Utils::Property::Energy>(total);
+  const double t = needsLocalization(level) ? es->getEnergy(Sty::ENERGY_CONTRIBUTIONS::TRIPLES_CORRECTION) : 0.0;
+  return sd + t;
+}
 
-  if (_requiredProperties.containsSubSet(Scine::Utils::Property::AtomicCharges)) {
-    auto charges = getMullikenCharges<ScfMode>();
-    _results->set<Scine::Utils::Property::AtomicCharges>(charges);
+template<Sty::Options::SCF_MODES ScfMode>
+double CCCalculator::correlate(const std::shared_ptr<Sty::SystemController>& system, Sty::Options::CC_LEVEL level) const {
+  const double hf = system->getElectronicStructure<ScfMode>()->getEnergy(Sty::ENERGY_CONTRIBUTIONS::HF_ENERGY);
+  if (needsLocalization(level)) {
+    localizeOrbitals(system);
   }
+  return hf + this->correlationEnergy<ScfMode>(system, level);
+}
+
+template<Sty::Options::SCF_MODES ScfMode>
+double CCCalculator::calculateEnergy(Sty::Options::CC_LEVEL level) {
+  using Clock = std::chrono::steady_clock;
+  const double hf = this->prepareReference<ScfMode>(needsLocalization(level), "cc");
+  const auto start = Clock::now();
+  const double correlation = this->correlationEnergy<ScfMode>(_system, level);
+  _calculationLog["correlation_time"] = std::to_string(std::chrono::duration<double>(Clock::now() - start).count());
+  return hf + correlation;
+}
 
-  /*
-   * Autocompletion part of the results
-   */
-  auto atomCollection = this->getStructure();
-  Scine::Utils::ResultsAutoCompleter completer(*atomCollection);
-  // Fill results with some basic data
-  //  - AO to Atom Mapping
-  auto indices = _system->getAtomCenteredBasisController()->getBasisIndices();
-  Scine::Utils::AtomsOrbitalsIndexes counts(indices.size());
-  for (const auto& index : indices) {
-    counts.addAtom(index.second - index.first);
+template<Sty::Options::SCF_MODES ScfMode>
+Eigen::MatrixXd CCCalculator::calculateGradients() const {
+  const double step = _settings->getDouble("numerical_gradient_step");
+  const auto level = this->level();
+  const auto positions = this->centralDisplacements(step);
+  const unsigned int nCoordinates = positions.size() / 2;
+  auto energies = this->runDisplacements(positions, false, [&](unsigned int task) -> Eigen::VectorXd {
+    // Starts from the orbitals of the reference geometry
+    std::shared_ptr<const ScratchManager::Directory> scratch;
+    auto system = this->displacedSystem<ScfMode>(positions[task], scratch);
+    Sty::ScfTask<ScfMode> scf(system);
+    scf.run();
+    return Eigen::VectorXd::Constant(1, this->correlate<ScfMode>(system, level));
+  });
+  Eigen::MatrixXd gradients(nCoordinates / 3, 3);
+  for (unsigned int i = 0; i < nCoordinates; ++i) {
+    gradients(i / 3, i % 3) = (energies(2 * i, 0) - energies(2 * i + 1, 0)) / (2.0 * step);
   }
-  _results->set<Scine::Utils::Property::AOtoAtomMapping>(counts);
-  //  - AO Overlap
-  _results->set<Scine::Utils::Property::OverlapMatrix>(_system->getOneElectronIntegralController()->getOverlapIntegrals());
+  return gradients;
+}
+
+template<Sty::Options::SCF_MODES ScfMode>
+void CCCalculator::calculateImpl() {
+  if (ScfMode == Sty::Options::SCF_MODES::UNRESTRICTED)
+    throw std::runtime_error("Unrestricted Coupled Cluster calculations are not yet supported in Serenity.");
+  const auto level = this->level();
+  // The numerical gradients always belong to the current system
+  this->runPlannedItems<ScfMode>([this, level]() { return this->calculateEnergy<ScfMode>(level); },
+                                 [this](const std::shared_ptr<Sty::SystemController>& /*system*/) {
+                                   return this->calculateGradients<ScfMode>();
+                                 },
+                                 false);
 }
 
 bool CCCalculator::supportsMethodFamily(const std::string& methodFamily) const {
@@ -15,6 +15,8 @@
 #include <Utils/CalculatorBasics.h>
 #include <Utils/Settings.h>
 #include <Utils/Technical/CloneInterface.h>
+#include <memory>
+#include <set>
 #include <string>
 
 namespace Serenity {
@@ -34,8 +36,8 @@ class CCCalculator : public Scine::Utils::CloneInterface<CCCalculator, Calculato
  public:
   static constexpr const char* model = "CC";
   static constexpr const char* program = "Serenity";
-  /// @brief Default Constructor
-  CCCalculator() = default;
+  /// @brief Default Constructor, adds the settings of local correlation and numerical gradients.
+  CCCalculator();
   /// @brief Default Destructor.
   ~CCCalculator() = default;
   /// @brief Copy Constructor.
@@ -62,15 +64,56 @@ class CCCalculator : public Scine::Utils::CloneInterface<CCCalculator, Calculato
   void applyFixedSettings(Sty::Settings& settings) const final;
   template<Sty::Options::SCF_MODES ScfMode>
   void calculateImpl();
+  /// @brief The CC level chosen by the 'method' setting.
+  Sty::Options::CC_LEVEL level() const;
+  /// @brief Whether a CC level is run on IBO-localized orbitals (those with triples).
+  static bool needsLocalization(Sty::Options::CC_LEVEL level);
+  /**
+   * @brief Runs the CC calculation on the orbitals present in a system.
+   * @return double The correlation energy (CCSD and triples corrections).
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  double correlationEnergy(const std::shared_ptr<Sty::SystemController>& system, Sty::Options::CC_LEVEL level) const;
+  /**
+   * @brief Runs the CC calculation (after IBO localization for triples) on a system with converged HF orbitals.
+   * @return double The total energy.
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  double correlate(const std::shared_ptr<Sty::SystemController>& system, Sty::Options::CC_LEVEL level) const;
+  /**
+   * @brief Calculates the CC energy of the current system.
+   *
+   * If only the correlation settings changed since the last call, the HF reference (and, if
+   * needed, the localization) is reused and only the CC calculation is rerun (see
+   * prepareReference()). Stage reuse and timings are reported in Property::Description.
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  double calculateEnergy(Sty::Options::CC_LEVEL level);
+  /**
+   * @brief Calculates the gradients by central finite differences of CC energies.
+   *
+   * The 6N displaced HF and CC calculations start from the orbitals of the current system
+   * and are distributed over 'displacement_workers' processes, the displacement is given by
+   * 'numerical_gradient_step'. Note that the accuracy depends on the convergence of the
+   * displaced energies ('self_consistence_criterion').
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  Eigen::MatrixXd calculateGradients() const;
   void calculateImplRestricted() final {
     this->calculateImpl<Sty::RESTRICTED>();
   }
   void calculateImplUnrestricted() final {
     this->calculateImpl<Sty::UNRESTRICTED>();
   }
+
+ private:
   inline std::vector<std::string> availableSolvationModels() const final {
     return {};
   }
+  /// @brief The CC level ('method') and the DLPNO thresholds only affect the correlation step.
+  std::set<std::string> correlationKeys() const override;
+  /// @brief The displacement of the numerical gradients only affects those.
+  std::set<std::string> gradientKeys() const override;
 };
 
 } /* namespace Serenity */
@@ -0,0 +1,93 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+/* Wrapper Includes */
+#include "Serenity/Calculators/CM5Charges.h"
+/* Scine Includes */
+#include <Utils/Constants.h>
+#include <Utils/Geometry/ElementInfo.h>
+/* External Includes */
+#include <array>
+#include <stdexcept>
+
+namespace Scine {
+namespace Serenity {
+
+namespace {
+constexpr unsigned int maxZ = 54;
+// Exponent (1/angstrom)
+constexpr double alpha = 2.474;
+// Atomic radii (angstrom), index Z - 1
+constexpr std::array<double, maxZ> radii = {
+    0.32, 0.37, 1.30, 0.99, 0.84, 0.75, 0.71, 0.64, 0.60, 0.62, 1.60, 1.40, 1.24, 1.14, 1.09, 1.04, 1.00, 1.01,
+    2.00, 1.74, 1.59, 1.48, 1.44, 1.30, 1.29, 1.24, 1.18, 1.17, 1.22, 1.20, 1.23, 1.20, 1.20, 1.18, 1.17, 1.16,
+    2.15, 1.90, 1.76, 1.64, 1.56, 1.46, 1.38, 1.36, 1.34, 1.30, 1.36, 1.40, 1.42, 1.40, 1.40, 1.37, 1.36, 1.36};
+// Element parameters D_Z, T_ZZ' = D_Z - D_Z' unless given below; index Z - 1
+constexpr std::array<double, maxZ> d = {
+    0.0056,  -0.1543, 0.0000,  0.0333,  -0.1030, -0.0446, -0.1072, -0.0802, -0.0629, -0.1088, 0.0184,
+    0.0000,  -0.0726, -0.0790, -0.0756, -0.0565, -0.0444, -0.0767, 0.0130,  0.0000,  0.0000,  0.0000,
+    0.0000,  0.0000,  0.0000,  0.0000,  0.0000,  0.0000,  0.0000,  0.0000,  -0.0512, -0.0557, -0.0533,
+    -0.0399, -0.0313, -0.0541, 0.0092,  0.0000,  0.0000,  0.0000,  0.0000,  0.0000,  0.0000,  0.0000,
+    0.0000,  0.0000,  0.0000,  0.0000,  -0.0361, -0.0393, -0.0376, -0.0255, -0.0195, -0.0290};
+
+double pairParameter(unsigned int zi, unsigned int zk) {
+  // Fitted pairs, antisymmetric
+  struct Pair {
+    unsigned int a;
+    unsigned int b;
+    double t;
+  };
+  static const std::array<Pair, 6> pairs = {
+      {{1, 6, 0.0502}, {1, 7, 0.1747}, {1, 8, 0.1671}, {6, 7, 0.0556}, {6, 8, 0.0234}, {7, 8, -0.0346}}};
+  for (const auto& pair : pairs) {
+    if (zi == pair.a && zk == pair.b) {
+      return pair.t;
+    }
+    if (zi == pair.b && zk == pair.a) {
+      return -pair.t;
+    }
+  }
+  return d[zi - 1] - d[zk - 1];
+}
+} // namespace
+
+std::vector<double> CM5Charges::fromHirshfeld(const std::vector<double>& hirshfeld, const Utils::ElementTypeCollection& elements,
+                                              const Utils::PositionCollection& positions) {
+  const auto nAtoms = static_cast<unsigned int>(elements.size());
+  Eigen::VectorXi z(nAtoms);
+  Eigen::VectorXd r(nAtoms);
+  for (unsigned int i = 0; i < nAtoms; ++i) {
+    z[i] = Utils::ElementInfo::Z(elements[i]);
+    if (z[i] < 1 || z[i] > static_cast<int>(maxZ)) {
+      throw std::runtime_error("CM5 charges are only available for elements up to Xe.");
+    }
+    r[i] = radii[z[i] - 1];
+  }
+  // All pair terms at once
+  Eigen::MatrixXd distances(nAtoms, nAtoms);
+  for (unsigned int k = 0; k < nAtoms; ++k) {
+    distances.col(k) = (positions.rowwise() - positions.row(k)).rowwise().norm() * Utils::Constants::angstrom_per_bohr;
+  }
+  Eigen::MatrixXd t(nAtoms, nAtoms);
+  for (unsigned int k = 0; k < nAtoms; ++k) {
+    for (unsigned int i = 0; i < nAtoms; ++i) {
+      t(i, k) = (i == k) ? 0.0 : pairParameter(z[i], z[k]);
+    }
+  }
+  Eigen::MatrixXd excess = distances;
+  excess.colwise() -= r;
+  excess.rowwise() -= r.transpose();
+  const Eigen::ArrayXXd b = (-alpha * excess.array()).exp();
+  const Eigen::VectorXd correction = (t.array() * b).rowwise().sum();
+  std::vector<double> charges(hirshfeld);
+  for (unsigned int i = 0; i < nAtoms; ++i) {
+    charges[i] += correction[i];
+  }
+  return charges;
+}
+
+} /* namespace Serenity */
+} /* namespace Scine */
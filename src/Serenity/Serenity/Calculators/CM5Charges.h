@@ -0,0 +1,44 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef SERENITY_CM5CHARGES_H_
+#define SERENITY_CM5CHARGES_H_
+
+/* Scine Includes */
+#include <Utils/Geometry/ElementTypes.h>
+#include <Utils/Typenames.h>
+/* External Includes */
+#include <vector>
+
+namespace Scine {
+namespace Serenity {
+
+/**
+ * @brief Charge Model 5 (A. V. Marenich et al., J. Chem. Theory Comput. 8, 527 (2012)).
+ *
+ * CM5 charges are Hirshfeld charges corrected by pairwise terms depending only on the
+ * elements and the interatomic distances:
+ *   q_i = q_i^H + sum_{k != i} T_{Z_i Z_k} exp(-alpha (r_ik - R_Z_i - R_Z_k)).
+ * Parameters are available for H to Xe.
+ */
+class CM5Charges {
+ public:
+  /**
+   * @brief Applies the CM5 correction.
+   * @param hirshfeld The Hirshfeld charges.
+   * @param elements  The elements.
+   * @param positions The positions (bohr).
+   * @return std::vector<double> The CM5 charges.
+   * @throws std::runtime_error For elements beyond Xe.
+   */
+  static std::vector<double> fromHirshfeld(const std::vector<double>& hirshfeld, const Utils::ElementTypeCollection& elements,
+                                           const Utils::PositionCollection& positions);
+};
+
+} /* namespace Serenity */
+} /* namespace Scine */
+
+#endif /* SERENITY_CM5CHARGES_H_ */
@@ -6,65 +6,180 @@
  */
 /* Wrapper Includes */
 #include "Serenity/Calculators/CalculatorBase.h"
+#include "Serenity/Calculators/CM5Charges.h"
+#include "Serenity/Calculators/DisplacementJob.h"
+#include "Serenity/Calculators/DisplacementWorkerPool.h"
+#include "Serenity/Calculators/GuessCache.h"
+#include "Serenity/Calculators/LibintEnginePool.h"
+#include "Serenity/Calculators/OutputContext.h"
 #include "Serenity/Calculators/ScineSettings.h"
 #include "Serenity/Calculators/SerenityState.h"
 /* Serenity Includes */
 #include <analysis/populationAnalysis/HirshfeldPopulationCalculator.h>
 #include <analysis/populationAnalysis/MullikenPopulationCalculator.h>
+#include <basis/AtomCenteredBasisController.h>
 #include <data/ElectronicStructure.h>
 #include <data/OrbitalController.h>
+#include <data/SpinPolarizedData.h>
 #include <data/grid/BasisFunctionOnGridController.h>
 #include <data/grid/BasisFunctionOnGridControllerFactory.h>
 #include <data/grid/DensityMatrixDensityOnGridController.h>
 #include <data/grid/DensityOnGridCalculator.h>
 #include <data/matrices/DensityMatrix.h>
+#include <energies/EnergyContributions.h>
 #include <geometry/Geometry.h>
+#include <geometry/gradients/NumericalHessianCalc.h>
 #include <grid/GridControllerFactory.h>
+#include <integrals/OneElectronIntegralController.h>
 #include <integrals/wrappers/Libint.h>
 #include <io/FormattedOutputStream.h>
 #include <math/Matrix.h>
+#include <misc/SerenityError.h>
+#include <settings/LocalCorrelationSettings.h>
+#include <settings/Settings.h>
 #include <system/SystemController.h>
+#include <tasks/LocalizationTask.h>
+#include <tasks/ScfTask.h>
 /* Scine Includes */
+#include <Utils/CalculatorBasics/ResultsAutoCompleter.h>
+#include <Utils/DataStructures/AtomsOrbitalsIndexes.h>
 #include <Utils/Geometry.h>
+#include <Utils/Scf/LcaoUtils/ElectronicOccupation.h>
 #include <Utils/Solvation/ImplicitSolvation.h>
 #include <Utils/Technical/UniqueIdentifier.h>
 #include <Utils/Typenames.h>
+#include <Utils/UniversalSettings/SettingsNames.h>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <stdexcept>
 
 using namespace Serenity;
 
 namespace Scine {
 namespace Serenity {
 
+namespace {
+// Copies a property between results if present, only checks its presence without target
+template<Scine::Utils::Property P>
+bool carry(const Scine::Utils::Results& from, Scine::Utils::Results* to) {
+  if (!from.has<P>()) {
+    return false;
+  }
+  if (to) {
+    to->set<P>(from.get<P>());
+  }
+  return true;
+}
+
+// Moves a property between results if present, results not needed anymore are left without it
+template<Scine::Utils::Property P>
+bool carry(Scine::Utils::Results& from, Scine::Utils::Results* to) {
+  if (!from.has<P>()) {
+    return false;
+  }
+  if (to) {
+    to->set<P>(from.take<P>());
+  }
+  return true;
+}
+
+// Copies (or moves, from non-const results) the outputs of a work item between results if all of them are present
+template<class Source>
+bool carryItem(PropertyPlanner::Item item, Source& from, Scine::Utils::Results* to) {
+  switch (item) {
+    case PropertyPlanner::Item::Scf:
+      return carry<Scine::Utils::Property::Energy>(from, to);
+    case PropertyPlanner::Item::Gradients:
+      return carry<Scine::Utils::Property::Gradients>(from, to);
+    case PropertyPlanner::Item::AtomicCharges:
+      return carry<Scine::Utils::Property::AtomicCharges>(from, to);
+    case PropertyPlanner::Item::IntegralExports:
+      return carry<Scine::Utils::Property::AOtoAtomMapping>(from, to) &&
+             carry<Scine::Utils::Property::OverlapMatrix>(from, to) &&
+             carry<Scine::Utils::Property::OneElectronMatrix>(from, to);
+    case PropertyPlanner::Item::DensityExports:
+      return carry<Scine::Utils::Property::DensityMatrix>(from, to) &&
+             carry<Scine::Utils::Property::ElectronicOccupation>(from, to);
+    case PropertyPlanner::Item::BondOrders:
+      return carry<Scine::Utils::Property::BondOrderMatrix>(from, to);
+    case PropertyPlanner::Item::Hessian:
+      return carry<Scine::Utils::Property::Hessian>(from, to);
+    case PropertyPlanner::Item::Thermochemistry:
+      return carry<Scine::Utils::Property::Thermochemistry>(from, to);
+  }
+  return false;
+}
+
+double binomial(int n, int k) {
+  if (k < 0 || k > n) {
+    return 0.0;
+  }
+  double value = 1.0;
+  for (int i = 1; i <= k; ++i) {
+    value *= static_cast<double>(n - k + i) / i;
+  }
+  return value;
+}
+
+/*
+ * Symmetric (Loewdin) orthonormalization of the columns of c with respect to the metric s.
+ */
+Eigen::MatrixXd orthonormalize(const Eigen::MatrixXd& c, const Eigen::MatrixXd& s) {
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> metric(c.transpose() * s * c);
+  return c * metric.operatorInverseSqrt();
+}
+
+/*
+ * Rotates the occupied and the virtual orbitals in c (separately) onto those of the reference,
+ * removing arbitrary phases and rotations within both spaces before extrapolating.
+ */
+Eigen::MatrixXd align(const Eigen::MatrixXd& c, const Eigen::MatrixXd& reference, unsigned int nOcc, const Eigen::MatrixXd& s) {
+  Eigen::MatrixXd aligned(c.rows(), c.cols());
+  const unsigned int nVirt = c.cols() - nOcc;
+  for (const auto& block : {std::make_pair(0u, nOcc), std::make_pair(nOcc, nVirt)}) {
+    if (block.second == 0) {
+      continue;
+    }
+    const auto from = c.middleCols(block.first, block.second);
+    const auto to = reference.middleCols(block.first, block.second);
+    Eigen::JacobiSVD<Eigen::MatrixXd> svd(from.transpose() * s * to, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    aligned.middleCols(block.first, block.second) = from * svd.matrixU() * svd.matrixV().transpose();
+  }
+  return aligned;
+}
+
+bool compatible(const SerenityState::OrbitalData& a, const SerenityState::OrbitalData& b) {
+  if (a.coefficients.size() != b.coefficients.size()) {
+    return false;
+  }
+  for (unsigned int i = 0; i < a.coefficients.size(); ++i) {
+    if (a.coefficients[i].rows() != b.coefficients[i].rows() || a.coefficients[i].cols() != b.coefficients[i].cols() ||
+        a.nOccupiedOrbitals[i] != b.nOccupiedOrbitals[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+} // namespace
+
 CalculatorBase::CalculatorBase()
   : _results(std::make_unique<Scine::Utils::Results>()),
     _system(nullptr),
     _geometry(nullptr),
     _scinePositions(nullptr),
-    _moved(true) {
+    _sharesGeometry(false) {
   this->_settings = std::make_unique<ScineSettings>();
-  auto& libint = Libint::getInstance();
-  libint.keepEngines(LIBINT_OPERATOR::coulomb, 0, 2);
-  libint.keepEngines(LIBINT_OPERATOR::coulomb, 0, 3);
-  libint.keepEngines(LIBINT_OPERATOR::coulomb, 0, 4);
-  libint.keepEngines(LIBINT_OPERATOR::coulomb, 1, 2);
-  libint.keepEngines(LIBINT_OPERATOR::coulomb, 1, 3);
-  libint.keepEngines(LIBINT_OPERATOR::coulomb, 1, 4);
 }
 
-CalculatorBase::~CalculatorBase() {
-  auto& libint = Libint::getInstance();
-  libint.freeEngines(LIBINT_OPERATOR::coulomb, 0, 2);
-  libint.freeEngines(LIBINT_OPERATOR::coulomb, 0, 3);
-  libint.freeEngines(LIBINT_OPERATOR::coulomb, 0, 4);
-  libint.freeEngines(LIBINT_OPERATOR::coulomb, 1, 2);
-  libint.freeEngines(LIBINT_OPERATOR::coulomb, 1, 3);
-  libint.freeEngines(LIBINT_OPERATOR::coulomb, 1, 4);
-}
+CalculatorBase::~CalculatorBase() = default;
 
 CalculatorBase::CalculatorBase(const CalculatorBase& other) {
   _system = nullptr;
   _settings = std::make_unique<ScineSettings>(*other._settings);
-  _moved = other._moved;
   if (other._geometry) {
     _geometry = std::make_shared<Geometry>(other._geometry->getAtomSymbols(), *other._scinePositions);
   }
@@ -83,13 +198,31 @@ CalculatorBase::CalculatorBase(const CalculatorBase& other) {
   else {
     _results = std::make_unique<Scine::Utils::Results>();
   }
-  auto& libint = Libint::getInstance();
-  libint.keepEngines(LIBINT_OPERATOR::coulomb, 0, 2);
-  libint.keepEngines(LIBINT_OPERATOR::coulomb, 0, 3);
-  libint.keepEngines(LIBINT_OPERATOR::coulomb, 0, 4);
-  libint.keepEngines(LIBINT_OPERATOR::coulomb, 1, 2);
-  libint.keepEngines(LIBINT_OPERATOR::coulomb, 1, 3);
-  libint.keepEngines(LIBINT_OPERATOR::coulomb, 1, 4);
+  // Without an electronic structure of its own the copy has to run an SCF
+  _planner.invalidate();
+  _gridStage = other._gridStage;
+  _lastMaxGradient = other._lastMaxGradient;
+  _staleOrbitals = other._staleOrbitals;
+  _sharesGeometry = false;
+  if (other._system && _settings->getBool("warm_clone")) {
+    OutputContext output(_settings->getBool("show_serenity_output"));
+    /*
+     * Share the geometry object: Serenity's factories then hand out the same basis,
+     * grid and one-electron integral controllers for both systems. The converged
+     * orbitals of the original serve as initial guess.
+     */
+    _geometry = other._geometry;
+    _system = this->createSystem(_geometry, other._system->getSettings(), _scratch);
+    _systemFingerprint = other._systemFingerprint;
+    copyElectronicStructure<RESTRICTED>(other._system, _system);
+    copyElectronicStructure<UNRESTRICTED>(other._system, _system);
+    _restrictedSnapshot = other._restrictedSnapshot;
+    _unrestrictedSnapshot = other._unrestrictedSnapshot;
+    _sharesGeometry = true;
+    other._sharesGeometry = true;
+  }
+  // Engines the original uses stay kept for the copy
+  _engines = other._engines;
 }
 
 Scine::Utils::Settings& CalculatorBase::settings() {
@@ -112,11 +245,18 @@ void CalculatorBase::setStructure(const Scine::Utils::AtomCollection& structure)
   }
   _geometry = std::make_shared<Geometry>(symbols, Eigen::MatrixXd(structure.getPositions()));
   _scinePositions = std::make_unique<Scine::Utils::PositionCollection>(structure.getPositions());
-  // TODO
-  //  if (_system != nullptr)
-  //    remove_all(_system->getSettings().path);
+  // Releasing the scratch directory removes the files of the old system
   _system = nullptr;
+  _scratch = nullptr;
+  _sharesGeometry = false;
+  _guessHistory.clear();
+  _staleOrbitals = false;
+  _restrictedSnapshot = nullptr;
+  _unrestrictedSnapshot = nullptr;
+  _gridStage = GridStage();
+  _lastMaxGradient = std::numeric_limits<double>::infinity();
   _results = std::make_unique<Scine::Utils::Results>();
+  _planner.invalidate();
 }
 
 std::unique_ptr<Scine::Utils::AtomCollection> CalculatorBase::getStructure() const {
@@ -138,19 +278,32 @@ void CalculatorBase::modifyPositions(Scine::Utils::PositionCollection newPositio
   if (!_geometry || !_scinePositions) {
     throw std::runtime_error("Missing geometry in a Serenity Calculator");
   };
-  auto diff = ((*_scinePositions) - newPositions).rowwise().norm();
-  if (_system && diff.maxCoeff() > 0.1) {
-    _system->setElectronicStructure<RESTRICTED>(nullptr);
-    _system->setElectronicStructure<UNRESTRICTED>(nullptr);
-  }
+  OutputContext output(this->_settings->getBool("show_serenity_output"));
+  this->detachGeometry();
+  // Whether the current orbitals are still a valid guess is decided in runScf()
   (*_scinePositions) = Scine::Utils::PositionCollection(newPositions);
-  auto old = iOOptions.printGridInfo;
-  iOOptions.printGridInfo = false;
-  _geometry->setCoordinates(newPositions);
-
-  iOOptions.printGridInfo = old;
+  {
+    OutputContext output(false);
+    _geometry->setCoordinates(newPositions);
+  }
   _results = std::make_unique<Scine::Utils::Results>();
-  this->_moved = true;
+  _planner.invalidate();
+}
+
+void CalculatorBase::detachGeometry() {
+  if (!_sharesGeometry) {
+    return;
+  }
+  _geometry = std::make_shared<Geometry>(_geometry->getAtomSymbols(), _geometry->getCoordinates());
+  if (_system) {
+    std::shared_ptr<const ScratchManager::Directory> scratch;
+    auto system = this->createSystem(_geometry, _system->getSettings(), scratch);
+    copyElectronicStructure<RESTRICTED>(_system, system);
+    copyElectronicStructure<UNRESTRICTED>(_system, system);
+    _system = system;
+    _scratch = scratch;
+  }
+  _sharesGeometry = false;
 }
 
 const Scine::Utils::PositionCollection& CalculatorBase::getPositions() const {
@@ -177,105 +330,70 @@ void CalculatorBase::loadState(std::shared_ptr<Scine::Core::State> state) {
   if (!castState)
     throw Scine::Core::StateCastingException();
 
-  //  TODO
-  //  // Remove old system
-  //  if (_system != nullptr)
-  //    remove_all(_system->getSettings().path);
-  //  _system = nullptr;
-
-  // Load state as new system
-  auto settings = Settings();
-  // throws error for wrong input and updates 'any' entries
-  Utils::Solvation::ImplicitSolvation::solvationNeededAndPossible(availableSolvationModels(), *_settings);
-  _settings->applyTo(settings);
-  this->applyFixedSettings(settings);
-  // Generate a unique name
-  Scine::Utils::UniqueIdentifier uid;
-  settings.name = uid.getStringRepresentation();
-
-  _geometry = std::make_shared<Geometry>(castState->system->getGeometry()->getAtomSymbols(),
-                                         castState->system->getGeometry()->getCoordinates());
-  //  auto old = iOOptions.printSystemInfoOnCreation;
-  //  iOOptions.printSystemInfoOnCreation = false;
-  _system = std::make_shared<SystemController>(_geometry, settings);
-  //  iOOptions.printSystemInfoOnCreation = old;
-
-  // Load data into the new system generated from the state
-  if (castState->system->hasElectronicStructure<RESTRICTED>()) {
-    CoefficientMatrix<RESTRICTED> coeff(_system->getBasisController());
-    auto orig = castState->system->getElectronicStructure<RESTRICTED>()->getMolecularOrbitals()->getCoefficients();
-    (Eigen::MatrixXd) coeff = (Eigen::MatrixXd)orig;
-    auto eval = castState->system->getElectronicStructure<RESTRICTED>()->getMolecularOrbitals()->getEigenvalues();
-    auto nCoreOrbs = castState->system->getElectronicStructure<RESTRICTED>()->getMolecularOrbitals()->getNCoreOrbitals();
-    auto orbitals = std::make_shared<OrbitalController<RESTRICTED>>(_system->getBasisController(), nCoreOrbs);
-    orbitals->updateOrbitals(coeff, eval);
-    auto es = std::make_shared<ElectronicStructure<RESTRICTED>>(orbitals, _system->getOneElectronIntegralController(),
-                                                                castState->system->getNOccupiedOrbitals<RESTRICTED>());
-    _system->setElectronicStructure<RESTRICTED>(es);
-  }
-  if (castState->system->hasElectronicStructure<UNRESTRICTED>()) {
-    CoefficientMatrix<UNRESTRICTED> coeff(_system->getBasisController());
-    auto orig = castState->system->getElectronicStructure<UNRESTRICTED>()->getMolecularOrbitals()->getCoefficients();
-    coeff.alpha = orig.alpha;
-    coeff.beta = orig.beta;
-    auto eval = castState->system->getElectronicStructure<UNRESTRICTED>()->getMolecularOrbitals()->getEigenvalues();
-    auto nCoreOrbs = castState->system->getElectronicStructure<UNRESTRICTED>()->getMolecularOrbitals()->getNCoreOrbitals();
-    auto orbitals = std::make_shared<OrbitalController<UNRESTRICTED>>(_system->getBasisController(), nCoreOrbs);
-    orbitals->updateOrbitals(coeff, eval);
-    auto es = std::make_shared<ElectronicStructure<UNRESTRICTED>>(orbitals, _system->getOneElectronIntegralController(),
-                                                                  castState->system->getNOccupiedOrbitals<UNRESTRICTED>());
-    _system->setElectronicStructure<UNRESTRICTED>(es);
+  OutputContext output(this->_settings->getBool("show_serenity_output"));
+  if (_system && _geometry->getAtomSymbols() == castState->getAtomSymbols()) {
+    // Keep the current system, only move it
+    this->detachGeometry();
+    OutputContext quiet(false);
+    _geometry->setCoordinates(castState->getCoordinates());
+  }
+  else {
+    // Remove old system
+    _system = nullptr;
+    _scratch = nullptr;
+    // Load state as new system
+    auto settings = Settings();
+    // throws error for wrong input and updates 'any' entries
+    Utils::Solvation::ImplicitSolvation::solvationNeededAndPossible(availableSolvationModels(), *_settings);
+    _settings->applyTo(settings);
+    this->applyFixedSettings(settings);
+    this->applyGridStage(settings);
+    _geometry = std::make_shared<Geometry>(castState->getAtomSymbols(), castState->getCoordinates());
+    _system = this->createSystem(_geometry, settings, _scratch);
+    _sharesGeometry = false;
+  }
+  _scinePositions = std::make_unique<Scine::Utils::PositionCollection>(castState->getCoordinates());
+  _guessHistory.clear();
+  _staleOrbitals = false;
+
+  // Load the orbitals into the system, they are shared with the state from now on
+  _system->setElectronicStructure<RESTRICTED>(nullptr);
+  _system->setElectronicStructure<UNRESTRICTED>(nullptr);
+  _restrictedSnapshot = castState->getRestrictedOrbitals();
+  _unrestrictedSnapshot = castState->getUnrestrictedOrbitals();
+  if (_restrictedSnapshot) {
+    applyOrbitals<RESTRICTED>(*_restrictedSnapshot, _system);
+  }
+  if (_unrestrictedSnapshot) {
+    applyOrbitals<UNRESTRICTED>(*_unrestrictedSnapshot, _system);
   }
   _results = std::make_unique<Scine::Utils::Results>();
+  _planner.invalidate();
 }
 
 std::shared_ptr<Scine::Core::State> CalculatorBase::getState() const {
   if (!_geometry) {
     throw std::runtime_error("Missing geometry in Serenity DFT Calculator");
   };
-  auto settings = Settings();
-  // throws error for wrong input and updates 'any' entries
-  Utils::Solvation::ImplicitSolvation::solvationNeededAndPossible(availableSolvationModels(), *_settings);
-  _settings->applyTo(settings);
-  this->applyFixedSettings(settings);
-  // Generate a unique name
-  Scine::Utils::UniqueIdentifier uid;
-  settings.name = uid.getStringRepresentation();
-  //  auto old = iOOptions.printSystemInfoOnCreation;
-  //  iOOptions.printSystemInfoOnCreation = false;
-  auto geometry = std::make_shared<Geometry>(_geometry->getAtomSymbols(), _geometry->getCoordinates());
-  auto system = std::make_shared<SystemController>(geometry, settings);
-  //  iOOptions.printSystemInfoOnCreation = old;
-
+  if (_staleOrbitals) {
+    return std::make_shared<SerenityState>(_geometry->getAtomSymbols(), _geometry->getCoordinates(), nullptr, nullptr);
+  }
   if (_system) {
-    if (_system->hasElectronicStructure<RESTRICTED>()) {
-      CoefficientMatrix<RESTRICTED> coeff(system->getBasisController());
-      (Eigen::MatrixXd) coeff =
-          (Eigen::MatrixXd)_system->getElectronicStructure<RESTRICTED>()->getMolecularOrbitals()->getCoefficients();
-      auto eval = _system->getElectronicStructure<RESTRICTED>()->getMolecularOrbitals()->getEigenvalues();
-      auto nCoreOrbs = _system->getElectronicStructure<RESTRICTED>()->getMolecularOrbitals()->getNCoreOrbitals();
-      auto orbitals = std::make_shared<OrbitalController<RESTRICTED>>(system->getBasisController(), nCoreOrbs);
-      orbitals->updateOrbitals(coeff, eval);
-      auto es = std::make_shared<ElectronicStructure<RESTRICTED>>(orbitals, system->getOneElectronIntegralController(),
-                                                                  _system->getNOccupiedOrbitals<RESTRICTED>());
-      system->setElectronicStructure<RESTRICTED>(es);
-    }
-    if (_system->hasElectronicStructure<UNRESTRICTED>()) {
-      CoefficientMatrix<UNRESTRICTED> coeff(system->getBasisController());
-      auto orig = _system->getElectronicStructure<UNRESTRICTED>()->getMolecularOrbitals()->getCoefficients();
-      coeff.alpha = orig.alpha;
-      coeff.beta = orig.beta;
-      auto eval = _system->getElectronicStructure<UNRESTRICTED>()->getMolecularOrbitals()->getEigenvalues();
-      auto nCoreOrbs = _system->getElectronicStructure<UNRESTRICTED>()->getMolecularOrbitals()->getNCoreOrbitals();
-      auto orbitals = std::make_shared<OrbitalController<UNRESTRICTED>>(system->getBasisController(), nCoreOrbs);
-      orbitals->updateOrbitals(coeff, eval);
-      auto es = std::make_shared<ElectronicStructure<UNRESTRICTED>>(orbitals, system->getOneElectronIntegralController(),
-                                                                    _system->getNOccupiedOrbitals<UNRESTRICTED>());
-      system->setElectronicStructure<UNRESTRICTED>(es);
-    }
-  }
-  system->setDiskMode(true);
-  return std::make_shared<SerenityState>(system);
+    if (!_restrictedSnapshot && _system->hasElectronicStructure<RESTRICTED>()) {
+      _restrictedSnapshot = extractOrbitals<RESTRICTED>(_system);
+    }
+    if (!_unrestrictedSnapshot && _system->hasElectronicStructure<UNRESTRICTED>()) {
+      _unrestrictedSnapshot = extractOrbitals<UNRESTRICTED>(_system);
+    }
+  }
+  auto state = std::make_shared<SerenityState>(_geometry->getAtomSymbols(), _geometry->getCoordinates(),
+                                               _restrictedSnapshot, _unrestrictedSnapshot);
+  if (_scratch) {
+    _stateTracker.track(state, _scratch);
+    const auto limit = static_cast<size_t>(_settings->getDouble("state_memory_limit") * 1024.0 * 1024.0);
+    _stateTracker.spillLeastRecent(limit);
+  }
+  return state;
 }
 
 const Scine::Utils::Results& CalculatorBase::calculate(std::string /*description*/) {
@@ -287,20 +405,21 @@ const Scine::Utils::Results& CalculatorBase::calculate(std::string /*description
     throw std::runtime_error("Unavailable Properties requested.");
   }
 
-  // Modify output level
-  bool showOutput = this->_settings->getBool("show_serenity_output");
-  if (!showOutput) {
-    GLOBAL_PRINT_LEVEL = Options::GLOBAL_PRINT_LEVELS::MINIMUM;
-    iOOptions.printFinalOrbitalEnergies = false;
-    iOOptions.printGeometry = false;
-    iOOptions.printSCFCycleInfo = false;
-    iOOptions.printSCFResults = false;
-    iOOptions.printDebugInfos = false;
-    iOOptions.printGridInfo = false;
-    iOOptions.gridAccuracyCheck = false;
-    iOOptions.timingsPrintLevel = 0;
-  }
+  // Modify output level, restored when leaving
+  OutputContext output(this->_settings->getBool("show_serenity_output"));
 
+  // Rebuild the system if any setting it depends on has changed
+  if (_system && this->systemFingerprint() != _systemFingerprint) {
+    _system = nullptr;
+    _scratch = nullptr;
+    _restrictedSnapshot = nullptr;
+    _unrestrictedSnapshot = nullptr;
+    _guessHistory.clear();
+    _staleOrbitals = false;
+    _gridStage = GridStage();
+    _planner.invalidate();
+  }
+  this->refineGrid();
   // System Initializations
   if (!_system) {
     // Parse current settings
@@ -311,15 +430,59 @@ const Scine::Utils::Results& CalculatorBase::calculate(std::string /*description
     _settings->applyTo(settings);
     // Apply fixed settings and those that are specific to the Calculator implementation at hand.
     this->applyFixedSettings(settings);
-    // Generate a unique name
-    Scine::Utils::UniqueIdentifier uid;
-    settings.name = uid.getStringRepresentation();
-    // Generate the system
-    _system = std::make_shared<SystemController>(_geometry, settings);
+    this->applyGridStage(settings);
+    // Generate the system in a scratch directory of its own
+    _system = this->createSystem(_geometry, settings, _scratch);
+  }
+  // Taken after setting up the system, which resolves 'any' entries
+  _systemFingerprint = this->systemFingerprint();
+  const std::string correlationFingerprint = this->settingsFingerprint(this->correlationKeys());
+  if (correlationFingerprint != _correlationFingerprint) {
+    _planner.invalidate(PropertyPlanner::Item::Scf);
+    _correlationFingerprint = correlationFingerprint;
+  }
+  const std::string chargeFingerprint = this->settingsFingerprint(this->chargeKeys());
+  if (chargeFingerprint != _chargeFingerprint) {
+    _planner.invalidate(PropertyPlanner::Item::AtomicCharges);
+    _chargeFingerprint = chargeFingerprint;
+  }
+  const std::string gradientFingerprint = this->settingsFingerprint(this->gradientKeys());
+  if (gradientFingerprint != _gradientFingerprint) {
+    _planner.invalidate(PropertyPlanner::Item::Gradients);
+    _gradientFingerprint = gradientFingerprint;
+  }
+  const std::string thermochemistryFingerprint = this->settingsFingerprint(this->thermochemistryKeys());
+  if (thermochemistryFingerprint != _thermochemistryFingerprint) {
+    _planner.invalidate(PropertyPlanner::Item::Thermochemistry);
+    _thermochemistryFingerprint = thermochemistryFingerprint;
+  }
+  // Loosely converged results only serve the calculation they were made for
+  if (_scfLoosened) {
+    _planner.invalidate(PropertyPlanner::Item::Scf);
+    _scfLoosened = false;
+  }
+  // Results of earlier calculations of the same positions and settings
+  _resultCache.setCapacity(static_cast<unsigned int>(_settings->getInt("result_cache_size")));
+  const std::string cacheKey = (_resultCache.getCapacity() > 0) ? this->resultCacheKey() : "";
+  _cachedResults = cacheKey.empty() ? nullptr : _resultCache.find(cacheKey, *_scinePositions);
+  _cacheCoversPlan = static_cast<bool>(_cachedResults);
+  if (_cachedResults) {
+    for (const auto item : PropertyPlanner::plan(_requiredProperties)) {
+      _cacheCoversPlan &= carryItem(item, *_cachedResults, nullptr);
+    }
   }
 
-  // Initialize the results
+  // Results of work items still up to date are carried over from the previous ones
+  _previousResults = std::move(_results);
   _results = std::make_unique<Scine::Utils::Results>();
+  _calculationLog.clear();
+  _planner.startCalculation();
+  this->leaseEngines();
+  // Orbitals shared with states stay valid, the SCF below creates new ones
+  if (!_planner.isValid(PropertyPlanner::Item::Scf)) {
+    _restrictedSnapshot = nullptr;
+    _unrestrictedSnapshot = nullptr;
+  }
 
   // Run the actual calculation
   try {
@@ -334,27 +497,552 @@ const Scine::Utils::Results& CalculatorBase::calculate(std::string /*description
     throw Core::UnsuccessfulCalculationException(e.what());
   }
 
-  // Reset output
-  if (!showOutput) {
-    iOOptions = IOOptions();
-  }
-
   _results->set<Scine::Utils::Property::ProgramName>("serenity");
+  _results->set<Scine::Utils::Property::SuccessfulCalculation>(true);
+  _previousResults = nullptr;
+  if (!cacheKey.empty()) {
+    // Extends the cached results, such that alternating property sets are all served
+    // A hit leaves the entry as it is, its lookup already marked it as recently used
+    if (!_cacheCoversPlan && !_scfLoosened) {
+      auto merged = _cachedResults ? std::make_shared<Scine::Utils::Results>(*_cachedResults)
+                                   : std::make_shared<Scine::Utils::Results>();
+      const Scine::Utils::Results& computed = *_results;
+      for (const auto item : PropertyPlanner::plan(_requiredProperties)) {
+        carryItem(item, computed, merged.get());
+      }
+      _resultCache.store(cacheKey, *_scinePositions, merged);
+    }
+    _calculationLog["result_cache"] = !_cachedResults ? "miss" : (_cacheCoversPlan ? "hit" : "partial");
+  }
+  // The cache keeps the dense matrices, later hits are screened again
+  this->screenMatrices();
+  // A full hit skips the SCF, the orbitals stay those of the last one
+  if (_cacheCoversPlan) {
+    _staleOrbitals = true;
+  }
+  _cachedResults = nullptr;
+  this->trackGridConvergence();
+  if (_results->has<Scine::Utils::Property::Gradients>()) {
+    _lastMaxGradient = _results->get<Scine::Utils::Property::Gradients>().cwiseAbs().maxCoeff();
+  }
+  _calculationLog["recomputed"] = this->itemNames(_planner.recomputed());
+  _calculationLog["reused"] = this->itemNames(_planner.reused());
+  if (!_calculationLog.empty()) {
+    std::ostringstream description;
+    for (const auto& entry : _calculationLog) {
+      description << (description.tellp() > 0 ? "; " : "") << entry.first << "=" << entry.second;
+    }
+    _results->set<Scine::Utils::Property::Description>(description.str());
+  }
 
   return *_results;
 }
 
+std::vector<Scine::Utils::Results> CalculatorBase::calculateBatch(const std::vector<Scine::Utils::PositionCollection>& positions) {
+  if (!_geometry || !_scinePositions) {
+    throw std::runtime_error("Missing geometry in a Serenity Calculator");
+  };
+  const Scine::Utils::PositionCollection original = *_scinePositions;
+  std::vector<Scine::Utils::Results> batch(positions.size());
+
+  // Order the geometries such that each one follows its nearest remaining neighbour
+  std::vector<unsigned int> remaining;
+  for (unsigned int i = 0; i < positions.size(); ++i) {
+    if (positions[i].rows() == original.rows()) {
+      remaining.push_back(i);
+    }
+    else {
+      batch[i].set<Scine::Utils::Property::SuccessfulCalculation>(false);
+      batch[i].set<Scine::Utils::Property::Description>("The number of positions does not match the structure.");
+    }
+  }
+  Scine::Utils::PositionCollection previous = original;
+  while (!remaining.empty()) {
+    auto nearest = std::min_element(remaining.begin(), remaining.end(), [&](unsigned int a, unsigned int b) {
+      return (positions[a] - previous).squaredNorm() < (positions[b] - previous).squaredNorm();
+    });
+    const unsigned int index = *nearest;
+    remaining.erase(nearest);
+    try {
+      this->modifyPositions(positions[index]);
+      this->calculate("");
+      // The next geometry (or the final reset) discards the results anyway
+      batch[index] = std::move(*_results);
+    }
+    catch (const std::exception& e) {
+      batch[index] = Scine::Utils::Results();
+      batch[index].set<Scine::Utils::Property::SuccessfulCalculation>(false);
+      batch[index].set<Scine::Utils::Property::Description>(e.what());
+      // Do not use a possibly broken electronic structure as guess for the next geometry
+      if (_system) {
+        _system->setElectronicStructure<RESTRICTED>(nullptr);
+        _system->setElectronicStructure<UNRESTRICTED>(nullptr);
+        _restrictedSnapshot = nullptr;
+        _unrestrictedSnapshot = nullptr;
+        _guessHistory.clear();
+      }
+    }
+    previous = positions[index];
+  }
+
+  this->modifyPositions(original);
+  return batch;
+}
+
+bool CalculatorBase::reuse(PropertyPlanner::Item item) {
+  // Moves the outputs over (the previous results are discarded afterwards), they may have been removed in between
+  if (_planner.isValid(item) && _previousResults && carryItem(item, *_previousResults, _results.get())) {
+    _planner.markReused(item);
+    return true;
+  }
+  /*
+   * Results of an earlier visit of the same positions. The SCF is only skipped if the
+   * cache covers all items, the others need the electronic structure of this geometry.
+   */
+  if (_cachedResults && (item != PropertyPlanner::Item::Scf || _cacheCoversPlan) &&
+      carryItem(item, *_cachedResults, _results.get())) {
+    _planner.markReused(item);
+    return true;
+  }
+  return false;
+}
+
+void CalculatorBase::clearResultCache() {
+  _resultCache.clear();
+}
+
+void CalculatorBase::screenMatrices() {
+  _screenedMatrices.clear();
+  const double threshold = _settings->getDouble("sparse_matrix_threshold");
+  if (threshold <= 0.0) {
+    return;
+  }
+  auto report = [&](const std::string& name, const ScreenedMatrix& screened) {
+    std::ostringstream error;
+    error << std::scientific << std::setprecision(1) << screened.maxError;
+    std::ostringstream retained;
+    retained << std::fixed << std::setprecision(3) << screened.retainedFraction;
+    _calculationLog["sparse_" + name + "_retained"] = retained.str();
+    _calculationLog["sparse_" + name + "_error"] = error.str();
+  };
+  // The dense AO matrices are replaced by their screened form, dropped from the results (see getScreenedMatrix())
+  const bool density = _requiredProperties.containsSubSet(Scine::Utils::Property::DensityMatrix) &&
+                       _results->has<Scine::Utils::Property::DensityMatrix>();
+  const bool overlap = _requiredProperties.containsSubSet(Scine::Utils::Property::OverlapMatrix) &&
+                       _results->has<Scine::Utils::Property::OverlapMatrix>();
+  if (density || overlap) {
+    const auto& blocks = _system->getAtomCenteredBasisController()->getBasisIndices();
+    if (density) {
+      const auto matrix = _results->take<Scine::Utils::Property::DensityMatrix>();
+      auto& screened = _screenedMatrices[{Scine::Utils::Property::DensityMatrix, "total"}];
+      screened = BlockScreening::screen(matrix.restrictedMatrix(), blocks, threshold);
+      report("density", screened);
+      if (matrix.unrestricted()) {
+        auto& alpha = _screenedMatrices[{Scine::Utils::Property::DensityMatrix, "alpha"}];
+        alpha = BlockScreening::screen(matrix.alphaMatrix(), blocks, threshold);
+        report("density_alpha", alpha);
+        auto& beta = _screenedMatrices[{Scine::Utils::Property::DensityMatrix, "beta"}];
+        beta = BlockScreening::screen(matrix.betaMatrix(), blocks, threshold);
+        report("density_beta", beta);
+      }
+    }
+    if (overlap) {
+      const auto matrix = _results->take<Scine::Utils::Property::OverlapMatrix>();
+      auto& screened = _screenedMatrices[{Scine::Utils::Property::OverlapMatrix, "total"}];
+      screened = BlockScreening::screen(matrix, blocks, threshold);
+      report("overlap", screened);
+    }
+  }
+  // The bond orders are sparse already, they are pruned in place
+  if (_requiredProperties.containsSubSet(Scine::Utils::Property::BondOrderMatrix) &&
+      _results->has<Scine::Utils::Property::BondOrderMatrix>()) {
+    auto bondOrders = _results->take<Scine::Utils::Property::BondOrderMatrix>();
+    const ScreenedMatrix screened = BlockScreening::screen(bondOrders.getMatrix(), threshold);
+    report("bond_orders", screened);
+    bondOrders.setMatrix(Eigen::SparseMatrix<double>(screened.matrix));
+    _results->set<Scine::Utils::Property::BondOrderMatrix>(std::move(bondOrders));
+  }
+}
+
+const ScreenedMatrix& CalculatorBase::getScreenedMatrix(Scine::Utils::Property property,
+                                                        const std::string& spin) const {
+  auto screened = _screenedMatrices.find({property, spin});
+  if (screened == _screenedMatrices.end()) {
+    throw std::runtime_error("The last calculation did not screen the requested property, "
+                             "see 'sparse_matrix_threshold' (bond orders are pruned in the results).");
+  }
+  return screened->second;
+}
+
+std::string CalculatorBase::resultCacheKey() const {
+  std::string key;
+  for (const auto& symbol : _geometry->getAtomSymbols()) {
+    key += symbol + ",";
+  }
+  key += ";" + this->settingsFingerprint(this->technicalKeys(), true);
+  // The grid changes with the stage of the adaptive grid mode
+  if (_settings->getBool("adaptive_grid")) {
+    key += _gridStage.final ? "grid=final;" : "grid=small;";
+  }
+  return key;
+}
+
+template<Options::SCF_MODES ScfMode>
+void CalculatorBase::setDensityProperties() {
+  //  - AO Density Matrix
+  const auto& dmat = _system->getElectronicStructure<ScfMode>()->getDensityMatrix();
+  _results->set<Scine::Utils::Property::DensityMatrix>(this->convertDensityMatrix(dmat, _system->getNElectrons<ScfMode>()));
+  //  - Occupations
+  auto occupation = Scine::Utils::LcaoUtils::ElectronicOccupation();
+  if (ScfMode == RESTRICTED) {
+    auto nElectrons = _system->getNElectrons<RESTRICTED>();
+    occupation.fillLowestRestrictedOrbitalsWithElectrons(nElectrons);
+  }
+  else {
+    auto nElectrons = _system->getNElectrons<UNRESTRICTED>();
+    occupation.fillLowestUnrestrictedOrbitals(nElectrons.alpha, nElectrons.beta);
+  }
+  _results->set<Scine::Utils::Property::ElectronicOccupation>(occupation);
+}
+
+template<Options::SCF_MODES ScfMode>
+void CalculatorBase::runPlannedItems(const std::function<double()>& energy, const GradientFunction& gradients,
+                                     bool displacedSystems) {
+  for (const auto item : PropertyPlanner::plan(_requiredProperties)) {
+    if (this->reuse(item)) {
+      continue;
+    }
+    switch (item) {
+      case PropertyPlanner::Item::Scf:
+        _results->set<Scine::Utils::Property::Energy>(energy());
+        break;
+      case PropertyPlanner::Item::Gradients: {
+        Eigen::MatrixXd systemGradients = gradients(_system);
+        _system->getGeometry()->setGradients(systemGradients);
+        _results->set<Scine::Utils::Property::Gradients>(systemGradients);
+        break;
+      }
+      case PropertyPlanner::Item::AtomicCharges:
+        _results->set<Scine::Utils::Property::AtomicCharges>(this->getAtomicCharges<ScfMode>());
+        break;
+      case PropertyPlanner::Item::IntegralExports:
+        this->setIntegralProperties();
+        break;
+      case PropertyPlanner::Item::DensityExports:
+        this->setDensityProperties<ScfMode>();
+        break;
+      case PropertyPlanner::Item::BondOrders:
+        this->completeProperty(Scine::Utils::Property::BondOrderMatrix);
+        break;
+      case PropertyPlanner::Item::Hessian:
+        if (!displacedSystems) {
+          throw std::logic_error("Hessians require gradients of displaced systems, which this calculator lacks.");
+        }
+        _results->set<Scine::Utils::Property::Hessian>(this->calculateHessian<ScfMode>(gradients));
+        break;
+      case PropertyPlanner::Item::Thermochemistry:
+        this->completeProperty(Scine::Utils::Property::Thermochemistry);
+        break;
+    }
+    _planner.markRecomputed(item);
+  }
+}
+
+void CalculatorBase::applyGridStage(Sty::Settings& settings) const {
+  if (_settings->getBool("adaptive_grid") && !_gridStage.final) {
+    settings.grid.accuracy = settings.grid.smallGridAccuracy;
+  }
+}
+
+void CalculatorBase::refineGrid() {
+  if (!_system || !_settings->getBool("adaptive_grid") || _gridStage.final) {
+    return;
+  }
+  if (_gridStage.gradientNorm >= _settings->getDouble("adaptive_grid_gradient_threshold") &&
+      _gridStage.energyChange >= _settings->getDouble("adaptive_grid_energy_threshold")) {
+    return;
+  }
+  _gridStage.final = true;
+  // Same system on the final grid, starting from the current orbitals
+  this->detachGeometry();
+  auto settings = _system->getSettings();
+  settings.grid.accuracy = _settings->getInt("grid_accuracy");
+  std::shared_ptr<const ScratchManager::Directory> scratch;
+  auto system = this->createSystem(_geometry, settings, scratch);
+  copyElectronicStructure<RESTRICTED>(_system, system);
+  copyElectronicStructure<UNRESTRICTED>(_system, system);
+  _system = system;
+  _scratch = scratch;
+  _guessHistory.clear();
+  _planner.invalidate();
+}
+
+void CalculatorBase::trackGridConvergence() {
+  if (!_settings->getBool("adaptive_grid")) {
+    return;
+  }
+  _calculationLog["grid"] = _gridStage.final ? "final" : "small";
+  if (_gridStage.final || !_results->has<Scine::Utils::Property::Energy>()) {
+    return;
+  }
+  const auto& recomputed = _planner.recomputed();
+  if (std::find(recomputed.begin(), recomputed.end(), PropertyPlanner::Item::Scf) != recomputed.end()) {
+    // A new geometry (same geometries are reused)
+    const double energy = _results->get<Scine::Utils::Property::Energy>();
+    if (!std::isnan(_gridStage.lastEnergy)) {
+      _gridStage.energyChange = std::abs(energy - _gridStage.lastEnergy);
+    }
+    _gridStage.lastEnergy = energy;
+  }
+  if (_results->has<Scine::Utils::Property::Gradients>()) {
+    _gridStage.gradientNorm = _results->get<Scine::Utils::Property::Gradients>().norm();
+  }
+}
+
+void CalculatorBase::leaseEngines() {
+  bool electronicStructure = false;
+  bool derivatives = false;
+  for (const auto item : PropertyPlanner::plan(_requiredProperties)) {
+    electronicStructure |= (item != PropertyPlanner::Item::IntegralExports);
+    derivatives |= (item == PropertyPlanner::Item::Gradients || item == PropertyPlanner::Item::Hessian);
+  }
+  // Leases for the new set first, engines used before and now stay kept
+  std::vector<LibintEnginePool::Lease> engines;
+  auto& pool = LibintEnginePool::getInstance();
+  const unsigned int nDerivatives = electronicStructure ? (derivatives ? 2 : 1) : 0;
+  for (unsigned int derivative = 0; derivative < nDerivatives; ++derivative) {
+    for (unsigned int nCenters = 2; nCenters <= 4; ++nCenters) {
+      engines.push_back(pool.acquire(LIBINT_OPERATOR::coulomb, derivative, nCenters));
+    }
+  }
+  _engines.swap(engines);
+}
+
+std::string CalculatorBase::itemNames(const std::vector<PropertyPlanner::Item>& items) {
+  std::string names;
+  for (const auto item : items) {
+    names += (names.empty() ? "" : ",") + PropertyPlanner::name(item);
+  }
+  return names.empty() ? "none" : names;
+}
+
+void CalculatorBase::completeProperty(Scine::Utils::Property property) {
+  auto atomCollection = this->getStructure();
+  Scine::Utils::ResultsAutoCompleter completer(*atomCollection);
+  completer.setWantedProperties(property);
+  completer.setTemperature(_settings->getDouble(Scine::Utils::SettingsNames::temperature));
+  completer.setPressure(_settings->getDouble(Scine::Utils::SettingsNames::pressure));
+  completer.generateProperties(*_results, *atomCollection);
+}
+
+const std::set<std::string>& CalculatorBase::localCorrelationKeys() {
+  static const std::set<std::string> keys = {"dlpno_accuracy",          "dlpno_pno_threshold",
+                                             "dlpno_pno_core_scaling",  "dlpno_pair_threshold",
+                                             "dlpno_doi_pao_threshold", "dlpno_mulliken_threshold",
+                                             "dlpno_orbital_to_shell_threshold"};
+  return keys;
+}
+
+std::set<std::string> CalculatorBase::technicalKeys() const {
+  return {"show_serenity_output",
+          "displacement_workers",
+          "displacement_threads_per_worker",
+          "displacement_timeout",
+          "scratch_directory",
+          "scratch_memory_limit",
+          "state_memory_limit",
+          "warm_clone",
+          "guess_cache_directory",
+          "guess_cache_size",
+          "atomic_charge_grid_block_size",
+          "result_cache_size",
+          "sparse_matrix_threshold"};
+}
+
+std::set<std::string> CalculatorBase::convergenceKeys() const {
+  return {"guess_extrapolation",
+          "guess_extrapolation_order",
+          "guess_min_overlap",
+          "guess_cache_tolerance",
+          "adaptive_grid_gradient_threshold",
+          "adaptive_grid_energy_threshold",
+          "adaptive_scf_threshold",
+          "adaptive_scf_factor",
+          "adaptive_scf_loosest_threshold"};
+}
+
+std::set<std::string> CalculatorBase::chargeKeys() const {
+  return {"atomic_charge_model"};
+}
+
+std::set<std::string> CalculatorBase::thermochemistryKeys() const {
+  return {Scine::Utils::SettingsNames::temperature, Scine::Utils::SettingsNames::pressure};
+}
+
+std::map<std::string, std::vector<std::string>> CalculatorBase::settingCategories() const {
+  const std::vector<std::pair<std::string, std::set<std::string>>> categories = {
+      {"technical", this->technicalKeys()},
+      {"convergence", this->convergenceKeys()},
+      {"charges", this->chargeKeys()},
+      {"gradients", this->gradientKeys()},
+      {"thermochemistry", this->thermochemistryKeys()},
+      {"correlation", this->correlationKeys()}};
+  std::map<std::string, std::vector<std::string>> result;
+  for (const auto& key : _settings->getKeys()) {
+    result[key];
+  }
+  for (const auto& category : categories) {
+    for (const auto& key : category.second) {
+      result[key].push_back(category.first);
+    }
+  }
+  for (auto& entry : result) {
+    if (entry.second.empty()) {
+      entry.second.push_back("system");
+    }
+  }
+  return result;
+}
+
+void CalculatorBase::applyLocalCorrelationSettings(Sty::LocalCorrelationSettings& settings) const {
+  // Serenity's presets first, thresholds given explicitly replace the preset values
+  auto accuracy = _settings->getString("dlpno_accuracy");
+  std::transform(accuracy.begin(), accuracy.end(), accuracy.begin(), ::toupper);
+  Sty::Options::resolve(accuracy, settings.pnoSettings);
+  settings.resolvePNOSettings();
+  auto replace = [&](const std::string& key, double& value) {
+    const double given = _settings->getDouble(key);
+    if (given > 0.0) {
+      value = given;
+    }
+  };
+  replace("dlpno_pno_threshold", settings.pnoThreshold);
+  replace("dlpno_pno_core_scaling", settings.pnoCoreScaling);
+  replace("dlpno_pair_threshold", settings.ccsdPairThreshold);
+  replace("dlpno_doi_pao_threshold", settings.doiPAOThreshold);
+  replace("dlpno_mulliken_threshold", settings.mullikenThreshold);
+  replace("dlpno_orbital_to_shell_threshold", settings.orbitalToShellThreshold);
+}
+
+void CalculatorBase::localizeOrbitals(const std::shared_ptr<SystemController>& system) {
+  LocalizationTask loc(system);
+  loc.settings.locType = Options::ORBITAL_LOCALIZATION_ALGORITHMS::IBO;
+  loc.run();
+}
+
+template<Options::SCF_MODES ScfMode>
+double CalculatorBase::prepareReference(bool localized, const std::string& prefix) {
+  auto& reference = _correlationReference;
+  const Eigen::MatrixXd positions = _geometry->getCoordinates();
+  // The stages belong to the current electronic structure, which loadState() or a new geometry replace
+  const bool reuse = reference.system.lock() == _system && reference.electronicStructure.lock() &&
+                     _system->hasElectronicStructure<ScfMode>() &&
+                     reference.electronicStructure.lock().get() == _system->getElectronicStructure<ScfMode>().get() &&
+                     reference.positions.rows() == positions.rows() && reference.positions == positions;
+  if (reuse) {
+    _calculationLog[prefix + "_reference"] = "reused";
+  }
+  else {
+    this->runScf<ScfMode>();
+    reference = CorrelationReference();
+    reference.system = _system;
+    reference.positions = positions;
+    reference.hfEnergy = _system->getElectronicStructure<ScfMode>()->getEnergy(ENERGY_CONTRIBUTIONS::HF_ENERGY);
+    reference.canonical = extractOrbitals<ScfMode>(_system);
+    reference.current = reference.canonical;
+    _calculationLog[prefix + "_reference"] = "computed";
+  }
+  // Orbitals of the required kind, each kind is only generated once per reference
+  const auto start = std::chrono::steady_clock::now();
+  if (localized) {
+    if (reference.localized) {
+      _calculationLog[prefix + "_localization"] = "reused";
+    }
+    else {
+      if (reference.current != reference.canonical) {
+        applyOrbitals<ScfMode>(*reference.canonical, _system);
+      }
+      localizeOrbitals(_system);
+      reference.localized = extractOrbitals<ScfMode>(_system);
+      reference.current = reference.localized;
+      _calculationLog[prefix + "_localization"] = "computed";
+    }
+  }
+  else {
+    _calculationLog[prefix + "_localization"] = "none";
+  }
+  const auto& orbitals = localized ? reference.localized : reference.canonical;
+  if (reference.current != orbitals) {
+    applyOrbitals<ScfMode>(*orbitals, _system);
+    reference.current = orbitals;
+  }
+  reference.electronicStructure = _system->getElectronicStructure<ScfMode>();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  _calculationLog["localization_time"] = std::to_string(elapsed.count());
+  return reference.hfEnergy;
+}
+
+std::string CalculatorBase::systemFingerprint() const {
+  std::set<std::string> keys;
+  for (const auto& category : {this->technicalKeys(), this->convergenceKeys(), this->chargeKeys(), this->gradientKeys(),
+                               this->thermochemistryKeys(), this->correlationKeys()}) {
+    keys.insert(category.begin(), category.end());
+  }
+  return this->settingsFingerprint(keys, true);
+}
+
+std::string CalculatorBase::settingsFingerprint(const std::set<std::string>& keys, bool complement) const {
+  std::ostringstream fingerprint;
+  fingerprint << std::setprecision(17);
+  for (const auto& key : _settings->getKeys()) {
+    if ((keys.count(key) > 0) == complement) {
+      continue;
+    }
+    const auto value = _settings->getValue(key);
+    fingerprint << key << "=";
+    if (value.isBool()) {
+      fingerprint << value.toBool();
+    }
+    else if (value.isInt()) {
+      fingerprint << value.toInt();
+    }
+    else if (value.isDouble()) {
+      fingerprint << value.toDouble();
+    }
+    else if (value.isString()) {
+      fingerprint << value.toString();
+    }
+    fingerprint << ";";
+  }
+  return fingerprint.str();
+}
+
+void CalculatorBase::setIntegralProperties() {
+  auto indices = _system->getAtomCenteredBasisController()->getBasisIndices();
+  Scine::Utils::AtomsOrbitalsIndexes counts(indices.size());
+  for (const auto& index : indices) {
+    counts.addAtom(index.second - index.first);
+  }
+  _results->set<Scine::Utils::Property::AOtoAtomMapping>(counts);
+  auto integrals = _system->getOneElectronIntegralController();
+  // One copy each, the integral controller keeps its matrices
+  _results->set<Scine::Utils::Property::OverlapMatrix>(Eigen::MatrixXd(integrals->getOverlapIntegrals()));
+  _results->set<Scine::Utils::Property::OneElectronMatrix>(Eigen::MatrixXd(integrals->getOneElectronIntegrals()));
+}
+
 template<>
-Scine::Utils::DensityMatrix CalculatorBase::convertDensityMatrix(DensityMatrix<RESTRICTED> dmat,
-                                                                 SpinPolarizedData<RESTRICTED, unsigned int, void> nEl) const {
+Scine::Utils::DensityMatrix
+CalculatorBase::convertDensityMatrix(const DensityMatrix<RESTRICTED>& dmat,
+                                     const SpinPolarizedData<RESTRICTED, unsigned int, void>& nEl) const {
   Scine::Utils::DensityMatrix ret;
   ret.setDensity(Eigen::MatrixXd(dmat), nEl);
   return ret;
 }
 
 template<>
-Scine::Utils::DensityMatrix CalculatorBase::convertDensityMatrix(DensityMatrix<UNRESTRICTED> dmat,
-                                                                 SpinPolarizedData<UNRESTRICTED, unsigned int, void> nEl) const {
+Scine::Utils::DensityMatrix
+CalculatorBase::convertDensityMatrix(const DensityMatrix<UNRESTRICTED>& dmat,
+                                     const SpinPolarizedData<UNRESTRICTED, unsigned int, void>& nEl) const {
   Scine::Utils::DensityMatrix ret;
   ret.setDensity(Eigen::MatrixXd(dmat.alpha), Eigen::MatrixXd(dmat.beta), nEl.alpha, nEl.beta);
   return ret;
@@ -370,9 +1058,14 @@ std::vector<double> CalculatorBase::getMullikenCharges() const {
 
 template<Options::SCF_MODES ScfMode>
 std::vector<double> CalculatorBase::getHirshfeldCharges() const {
-  auto basFuncOnGridController = BasisFunctionOnGridControllerFactory::produce(128, 0.0, 2, _system->getBasisController(),
-                                                                               _system->getGridController());
-  auto densOnGridCalc = std::make_shared<DensityOnGridCalculator<ScfMode>>(basFuncOnGridController, 0.0);
+  // The controller follows changes of the basis and the grid of its system, hence is kept along with it
+  const auto blockSize = static_cast<unsigned int>(_settings->getInt("atomic_charge_grid_block_size"));
+  if (!_chargeGridFunctions || _chargeGridSystem.lock() != _system || _chargeGridFunctions->getMaxBlockSize() != blockSize) {
+    _chargeGridFunctions = BasisFunctionOnGridControllerFactory::produce(blockSize, 0.0, 2, _system->getBasisController(),
+                                                                         _system->getGridController());
+    _chargeGridSystem = _system;
+  }
+  auto densOnGridCalc = std::make_shared<DensityOnGridCalculator<ScfMode>>(_chargeGridFunctions, 0.0);
   auto densMatController = _system->getElectronicStructure<ScfMode>()->getDensityMatrixController();
   auto densOnGridController =
       std::make_shared<DensityMatrixDensityOnGridController<ScfMode>>(densOnGridCalc, densMatController);
@@ -382,6 +1075,19 @@ std::vector<double> CalculatorBase::getHirshfeldCharges() const {
   return populationToCharges<ScfMode>(populations);
 }
 
+template<Options::SCF_MODES ScfMode>
+std::vector<double> CalculatorBase::getAtomicCharges() const {
+  const std::string model = _settings->getString("atomic_charge_model");
+  if (model == "hirshfeld") {
+    return this->getHirshfeldCharges<ScfMode>();
+  }
+  if (model == "cm5") {
+    auto atoms = this->getStructure();
+    return CM5Charges::fromHirshfeld(this->getHirshfeldCharges<ScfMode>(), atoms->getElements(), atoms->getPositions());
+  }
+  return this->getMullikenCharges<ScfMode>();
+}
+
 template<Options::SCF_MODES ScfMode>
 std::vector<double> CalculatorBase::populationToCharges(const SpinPolarizedData<ScfMode, Eigen::VectorXd>& populations) const {
   std::vector<double> charges;
@@ -393,6 +1099,358 @@ std::vector<double> CalculatorBase::populationToCharges(const SpinPolarizedData<
   return charges;
 }
 
+template<Options::SCF_MODES ScfMode>
+std::shared_ptr<const SerenityState::OrbitalData>
+CalculatorBase::extractOrbitals(const std::shared_ptr<SystemController>& system) {
+  auto orbitals = system->getElectronicStructure<ScfMode>()->getMolecularOrbitals();
+  const auto& coeff = orbitals->getCoefficients();
+  const auto& eval = orbitals->getEigenvalues();
+  const auto core = orbitals->getNCoreOrbitals();
+  const auto occ = system->getNOccupiedOrbitals<ScfMode>();
+  std::vector<Eigen::MatrixXd> coefficients;
+  std::vector<Eigen::VectorXd> eigenvalues;
+  std::vector<unsigned int> nCore;
+  std::vector<unsigned int> nOcc;
+  for_spin(coeff, eval, core, occ) {
+    coefficients.push_back(coeff_spin);
+    eigenvalues.push_back(eval_spin);
+    nCore.push_back(core_spin);
+    nOcc.push_back(occ_spin);
+  };
+  return std::make_shared<SerenityState::OrbitalData>(std::move(coefficients), std::move(eigenvalues), std::move(nCore),
+                                                      std::move(nOcc));
+}
+
+template<Options::SCF_MODES ScfMode>
+void CalculatorBase::applyOrbitals(const SerenityState::OrbitalData& data, const std::shared_ptr<SystemController>& system) {
+  auto basisController = system->getBasisController();
+  CoefficientMatrix<ScfMode> coeff(basisController);
+  SpinPolarizedData<ScfMode, Eigen::VectorXd> eval(Eigen::VectorXd::Zero(0));
+  SpinPolarizedData<ScfMode, unsigned int> nCore(0);
+  SpinPolarizedData<ScfMode, unsigned int> nOcc(0);
+  unsigned int i = 0;
+  for_spin(coeff, eval, nCore, nOcc) {
+    if (data.coefficients[i].rows() != coeff_spin.rows()) {
+      throw std::runtime_error("The orbitals of the Serenity state do not match the basis of the system.");
+    }
+    coeff_spin = data.coefficients[i];
+    eval_spin = data.eigenvalues[i];
+    nCore_spin = data.nCoreOrbitals[i];
+    nOcc_spin = data.nOccupiedOrbitals[i];
+    ++i;
+  };
+  auto orbitals = std::make_shared<OrbitalController<ScfMode>>(basisController, nCore);
+  orbitals->updateOrbitals(coeff, eval);
+  auto es = std::make_shared<ElectronicStructure<ScfMode>>(orbitals, system->getOneElectronIntegralController(), nOcc);
+  system->setElectronicStructure<ScfMode>(es);
+}
+
+template<Options::SCF_MODES ScfMode>
+void CalculatorBase::copyElectronicStructure(const std::shared_ptr<SystemController>& source,
+                                             const std::shared_ptr<SystemController>& target) {
+  if (!source->hasElectronicStructure<ScfMode>()) {
+    return;
+  }
+  auto sourceOrbitals = source->getElectronicStructure<ScfMode>()->getMolecularOrbitals();
+  const auto& orig = sourceOrbitals->getCoefficients();
+  CoefficientMatrix<ScfMode> coeff(target->getBasisController());
+  for_spin(coeff, orig) {
+    coeff_spin = orig_spin;
+  };
+  auto orbitals =
+      std::make_shared<OrbitalController<ScfMode>>(target->getBasisController(), sourceOrbitals->getNCoreOrbitals());
+  orbitals->updateOrbitals(coeff, sourceOrbitals->getEigenvalues());
+  auto es = std::make_shared<ElectronicStructure<ScfMode>>(orbitals, target->getOneElectronIntegralController(),
+                                                           source->getNOccupiedOrbitals<ScfMode>());
+  target->setElectronicStructure<ScfMode>(es);
+}
+
+Settings CalculatorBase::systemSettings() const {
+  auto settings = _system->getSettings();
+  settings.scf.energyThreshold = _settings->getDouble(Scine::Utils::SettingsNames::selfConsistenceCriterion);
+  settings.scf.rmsdThreshold = _settings->getDouble("scf_rmsdThreshold");
+  return settings;
+}
+
+std::shared_ptr<SystemController> CalculatorBase::createSystem(std::shared_ptr<Geometry> geometry, Settings settings,
+                                                               std::shared_ptr<const ScratchManager::Directory>& scratch) const {
+  scratch = ScratchManager::getInstance().acquire(_settings->scratchRoot(), _settings->getDouble("scratch_memory_limit"));
+  settings.path = scratch->root();
+  settings.name = scratch->name();
+  return std::make_shared<SystemController>(geometry, settings);
+}
+
+template<Options::SCF_MODES ScfMode>
+std::shared_ptr<SystemController>
+CalculatorBase::displacedSystem(const Eigen::MatrixXd& coordinates,
+                                std::shared_ptr<const ScratchManager::Directory>& scratch) const {
+  auto geometry = std::make_shared<Geometry>(_geometry->getAtomSymbols(), coordinates);
+  auto system = this->createSystem(geometry, this->systemSettings(), scratch);
+  copyElectronicStructure<ScfMode>(_system, system);
+  return system;
+}
+
+template<Options::SCF_MODES ScfMode>
+Eigen::MatrixXd CalculatorBase::calculateHessian(const GradientFunction& gradients) const {
+  if (_settings->getInt("displacement_workers") <= 1) {
+    // reroute output, reset when leaving
+    OutputContext output(_settings->getBool("show_serenity_output"));
+    output.redirect(_scratch->path() + "hessian.cout.txt");
+    NumericalHessianCalc<ScfMode> hessianCalc(0.0e0, 0.001, true);
+    try {
+      return hessianCalc.calcHessian(_system);
+    }
+    catch (SerenityError& e) {
+      throw Core::UnsuccessfulCalculationException(e.what());
+    }
+  }
+
+  // Same displacement as the serial NumericalHessianCalc above
+  const double step = 0.001;
+  const auto positions = this->centralDisplacements(step);
+  const unsigned int nCoordinates = positions.size() / 2;
+  auto displaced = this->runDisplacements(positions, true, [&](unsigned int task) -> Eigen::VectorXd {
+    std::shared_ptr<const ScratchManager::Directory> scratch;
+    auto system = this->displacedSystem<ScfMode>(positions[task], scratch);
+    ScfTask<ScfMode> scf(system);
+    scf.run();
+    // Flatten atom-wise (x1, y1, z1, x2, ...) in order to match the coordinate indices
+    Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> g = gradients(system);
+    return Eigen::Map<const Eigen::VectorXd>(g.data(), g.size());
+  });
+  Eigen::MatrixXd hessian(nCoordinates, nCoordinates);
+  for (unsigned int i = 0; i < nCoordinates; ++i) {
+    hessian.row(i) = (displaced.row(2 * i) - displaced.row(2 * i + 1)) / (2.0 * step);
+  }
+  return 0.5 * (hessian + hessian.transpose());
+}
+
+std::vector<Eigen::MatrixXd> CalculatorBase::centralDisplacements(double step) const {
+  const Eigen::MatrixXd reference = _geometry->getCoordinates();
+  const unsigned int nCoordinates = 3 * reference.rows();
+  std::vector<Eigen::MatrixXd> positions(2 * nCoordinates, reference);
+  for (unsigned int i = 0; i < nCoordinates; ++i) {
+    positions[2 * i](i / 3, i % 3) += step;
+    positions[2 * i + 1](i / 3, i % 3) -= step;
+  }
+  return positions;
+}
+
+Eigen::MatrixXd CalculatorBase::runDisplacements(const std::vector<Eigen::MatrixXd>& positions, bool gradients,
+                                                 const std::function<Eigen::VectorXd(unsigned int)>& task) const {
+  const auto nTasks = static_cast<unsigned int>(positions.size());
+  const unsigned int resultSize = gradients ? 3 * _geometry->getCoordinates().rows() : 1;
+  DisplacementWorkerPool pool(_settings->getInt("displacement_workers"), _settings->getInt("displacement_threads_per_worker"),
+                              _settings->getDouble("displacement_timeout"));
+  if (!pool.spawnsWorkers(nTasks)) {
+    return pool.run(nTasks, resultSize, task);
+  }
+  // The workers start from the current orbitals, with the current grid and SCF thresholds
+  ScineSettings settings(*_settings);
+  settings.modifyInt("displacement_workers", 1);
+  settings.modifyInt("result_cache_size", 0);
+  settings.modifyString("guess_cache_directory", "");
+  settings.modifyString("guess_extrapolation", "none");
+  settings.modifyBool("adaptive_scf_threshold", false);
+  if (settings.getBool("adaptive_grid")) {
+    settings.modifyBool("adaptive_grid", false);
+    settings.modifyInt("grid_accuracy", _system->getSettings().grid.accuracy);
+  }
+  Scine::Utils::UniqueIdentifier uid;
+  const std::string job = _scratch->path() + "displacements_" + uid.getStringRepresentation() + ".bin";
+  DisplacementJob::write(job, this->name(), settings, this->getState(), positions, gradients);
+  try {
+    auto results = pool.run(job, nTasks, resultSize);
+    DisplacementJob::remove(job);
+    return results;
+  }
+  catch (...) {
+    DisplacementJob::remove(job);
+    throw;
+  }
+}
+
+template<Options::SCF_MODES ScfMode>
+void CalculatorBase::runScf() {
+  /*
+   * Far from stationary points the thresholds are loosened for this SCF only. The
+   * error of the gradients is linear, the one of the energy quadratic in the density
+   * error, hence the energy threshold scales with the squared largest gradient component.
+   * Hessians differentiate the gradients of this SCF, they always use the requested thresholds.
+   */
+  auto settings = this->systemSettings();
+  const double energyThreshold = settings.scf.energyThreshold;
+  const double rmsdThreshold = settings.scf.rmsdThreshold;
+  const auto plan = PropertyPlanner::plan(_requiredProperties);
+  const bool hessian = std::find(plan.begin(), plan.end(), PropertyPlanner::Item::Hessian) != plan.end();
+  if (_settings->getBool("adaptive_scf_threshold") && std::isfinite(_lastMaxGradient) && !hessian) {
+    const double loosest = std::max(_settings->getDouble("adaptive_scf_loosest_threshold"), energyThreshold);
+    const double scaled = _settings->getDouble("adaptive_scf_factor") * _lastMaxGradient * _lastMaxGradient;
+    settings.scf.energyThreshold = std::min(std::max(scaled, energyThreshold), loosest);
+    settings.scf.rmsdThreshold = rmsdThreshold * std::sqrt(settings.scf.energyThreshold / energyThreshold);
+  }
+  _scfLoosened = (settings.scf.energyThreshold != energyThreshold);
+  const auto& current = _system->getSettings().scf;
+  if (current.energyThreshold != settings.scf.energyThreshold || current.rmsdThreshold != settings.scf.rmsdThreshold) {
+    // Serenity reads the thresholds from the system: same system on other thresholds, starting from its orbitals
+    this->detachGeometry();
+    std::shared_ptr<const ScratchManager::Directory> scratch;
+    auto system = this->createSystem(_geometry, settings, scratch);
+    copyElectronicStructure<RESTRICTED>(_system, system);
+    copyElectronicStructure<UNRESTRICTED>(_system, system);
+    _system = system;
+    _scratch = scratch;
+  }
+  const std::string guess = this->prepareGuess<ScfMode>();
+  std::ostringstream threshold;
+  threshold << std::scientific << std::setprecision(1) << settings.scf.energyThreshold;
+  const auto start = std::chrono::steady_clock::now();
+  ScfTask<ScfMode> scf(_system);
+  scf.run();
+  _staleOrbitals = false;
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  /*
+   * Serenity does not expose the number of SCF cycles, the wall time of the SCF
+   * is reported in order to judge the quality of the guess.
+   */
+  _calculationLog["scf_guess"] = guess;
+  _calculationLog["scf_threshold"] = threshold.str();
+  _calculationLog["scf_time"] = std::to_string(elapsed.count());
+
+  std::shared_ptr<const SerenityState::OrbitalData> converged;
+  const std::string cacheDirectory = _settings->getString("guess_cache_directory");
+  // Loosely converged orbitals would be taken for converged ones by later runs
+  if (!cacheDirectory.empty() && !_scfLoosened) {
+    converged = extractOrbitals<ScfMode>(_system);
+    GuessCache cache(cacheDirectory, _settings->getDouble("guess_cache_size"));
+    cache.store(this->guessCacheKey(), _geometry->getCoordinates(), *converged);
+  }
+  if (_settings->getString("guess_extrapolation") == "aspc") {
+    _guessHistory.push_back(converged ? converged : extractOrbitals<ScfMode>(_system));
+    const unsigned int length = _settings->getInt("guess_extrapolation_order") + 2;
+    while (_guessHistory.size() > length) {
+      _guessHistory.pop_front();
+    }
+  }
+  else {
+    _guessHistory.clear();
+  }
+}
+
+template<Options::SCF_MODES ScfMode>
+std::string CalculatorBase::prepareGuess() {
+  if (!_system->hasElectronicStructure<ScfMode>()) {
+    _guessHistory.clear();
+    if (!this->loadCachedGuess<ScfMode>()) {
+      return "initial";
+    }
+  }
+  const Eigen::MatrixXd& overlap = _system->getOneElectronIntegralController()->getOverlapIntegrals();
+  auto latest = extractOrbitals<ScfMode>(_system);
+  // The occupied orbitals of the last geometry have to remain (close to) orthonormal at the new one
+  const double minOverlap = _settings->getDouble("guess_min_overlap");
+  for (unsigned int i = 0; i < latest->coefficients.size(); ++i) {
+    const unsigned int nOcc = latest->nOccupiedOrbitals[i];
+    if (nOcc == 0) {
+      continue;
+    }
+    const auto occ = latest->coefficients[i].leftCols(nOcc);
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> metric(occ.transpose() * overlap * occ, Eigen::EigenvaluesOnly);
+    if (metric.eigenvalues().minCoeff() < minOverlap) {
+      _system->setElectronicStructure<ScfMode>(nullptr);
+      _guessHistory.clear();
+      return "initial";
+    }
+  }
+  const std::string mode = _settings->getString("guess_extrapolation");
+  if (mode == "none") {
+    return "previous";
+  }
+
+  // The orbitals to extrapolate from, newest first
+  std::vector<std::shared_ptr<const SerenityState::OrbitalData>> steps = {latest};
+  if (mode == "aspc" && !_guessHistory.empty() && compatible(*latest, *_guessHistory.back())) {
+    // The newest entry of the history belongs to the current electronic structure
+    steps.clear();
+    const unsigned int maxSteps = _settings->getInt("guess_extrapolation_order") + 2;
+    for (auto it = _guessHistory.rbegin(); it != _guessHistory.rend() && steps.size() < maxSteps; ++it) {
+      if (!compatible(*latest, **it)) {
+        break;
+      }
+      steps.push_back(*it);
+    }
+  }
+  /*
+   * Predictor coefficients of order k = nSteps - 2:
+   *   B_j = (-1)^(j+1) j binom(2k+4, k+2-j) / binom(2k+2, k+1)
+   * (J. Kolafa, J. Comput. Chem. 25, 335 (2004)).
+   */
+  const auto nSteps = static_cast<int>(steps.size());
+  std::vector<double> weights(1, 1.0);
+  if (nSteps >= 2) {
+    const int k = nSteps - 2;
+    weights.clear();
+    for (int j = 1; j <= nSteps; ++j) {
+      weights.push_back(((j % 2 == 1) ? 1.0 : -1.0) * j * binomial(2 * k + 4, k + 2 - j) / binomial(2 * k + 2, k + 1));
+    }
+  }
+  std::vector<Eigen::MatrixXd> coefficients;
+  for (unsigned int i = 0; i < latest->coefficients.size(); ++i) {
+    const Eigen::MatrixXd& reference = steps[0]->coefficients[i];
+    Eigen::MatrixXd guess = weights[0] * reference;
+    for (unsigned int j = 1; j < weights.size(); ++j) {
+      guess += weights[j] * align(steps[j]->coefficients[i], reference, steps[0]->nOccupiedOrbitals[i], overlap);
+    }
+    coefficients.push_back(orthonormalize(guess, overlap));
+  }
+  SerenityState::OrbitalData guess(std::move(coefficients), steps[0]->eigenvalues, steps[0]->nCoreOrbitals,
+                                   steps[0]->nOccupiedOrbitals);
+  _system->setElectronicStructure<ScfMode>(nullptr);
+  applyOrbitals<ScfMode>(guess, _system);
+  return (nSteps >= 2) ? "aspc" : "projected";
+}
+
+template<Options::SCF_MODES ScfMode>
+bool CalculatorBase::loadCachedGuess() {
+  const std::string directory = _settings->getString("guess_cache_directory");
+  if (directory.empty()) {
+    return false;
+  }
+  GuessCache cache(directory, _settings->getDouble("guess_cache_size"));
+  bool exact = false;
+  auto orbitals = cache.load(this->guessCacheKey(), _geometry->getCoordinates(),
+                             _settings->getDouble("guess_cache_tolerance"), exact);
+  const unsigned int nSpins = (ScfMode == RESTRICTED) ? 1 : 2;
+  if (orbitals && orbitals->coefficients.size() == nSpins) {
+    try {
+      applyOrbitals<ScfMode>(*orbitals, _system);
+      _calculationLog["guess_cache"] = exact ? "exact" : "nearby";
+      return true;
+    }
+    catch (const std::runtime_error&) {
+      // Fall through, the entry does not match the basis
+    }
+  }
+  _calculationLog["guess_cache"] = "miss";
+  return false;
+}
+
+std::string CalculatorBase::guessCacheKey() const {
+  // The reference method set by applyFixedSettings(), calculators sharing it (HF, CC, MP2) share their orbitals
+  const auto& settings = _system->getSettings();
+  std::ostringstream key;
+  key << static_cast<int>(settings.method);
+  if (settings.method == Options::ELECTRONIC_STRUCTURE_THEORIES::DFT) {
+    key << "/" << static_cast<int>(settings.dft.functional);
+  }
+  key << "|" << settings.basis.label << "|" << settings.charge << "|" << settings.spin << "|"
+      << static_cast<int>(settings.scfMode);
+  for (const auto& symbol : _geometry->getAtomSymbols()) {
+    key << "|" << symbol;
+  }
+  return key.str();
+}
+
 template std::vector<double> CalculatorBase::populationToCharges<Options::SCF_MODES::RESTRICTED>(
     const SpinPolarizedData<Options::SCF_MODES::RESTRICTED, Eigen::VectorXd>&) const;
 template std::vector<double> CalculatorBase::populationToCharges<Options::SCF_MODES::UNRESTRICTED>(
@@ -401,6 +1459,40 @@ template std::vector<double> CalculatorBase::getMullikenCharges<Options::SCF_MOD
 template std::vector<double> CalculatorBase::getMullikenCharges<Options::SCF_MODES::UNRESTRICTED>() const;
 template std::vector<double> CalculatorBase::getHirshfeldCharges<Options::SCF_MODES::RESTRICTED>() const;
 template std::vector<double> CalculatorBase::getHirshfeldCharges<Options::SCF_MODES::UNRESTRICTED>() const;
+template std::vector<double> CalculatorBase::getAtomicCharges<Options::SCF_MODES::RESTRICTED>() const;
+template std::vector<double> CalculatorBase::getAtomicCharges<Options::SCF_MODES::UNRESTRICTED>() const;
+template Eigen::MatrixXd
+CalculatorBase::calculateHessian<Options::SCF_MODES::RESTRICTED>(const GradientFunction& gradients) const;
+template Eigen::MatrixXd
+CalculatorBase::calculateHessian<Options::SCF_MODES::UNRESTRICTED>(const GradientFunction& gradients) const;
+template void CalculatorBase::setDensityProperties<Options::SCF_MODES::RESTRICTED>();
+template void CalculatorBase::setDensityProperties<Options::SCF_MODES::UNRESTRICTED>();
+template void CalculatorBase::runPlannedItems<Options::SCF_MODES::RESTRICTED>(const std::function<double()>& energy,
+                                                                              const GradientFunction& gradients,
+                                                                              bool displacedSystems);
+template void CalculatorBase::runPlannedItems<Options::SCF_MODES::UNRESTRICTED>(const std::function<double()>& energy,
+                                                                                const GradientFunction& gradients,
+                                                                                bool displacedSystems);
+template void CalculatorBase::runScf<Options::SCF_MODES::RESTRICTED>();
+template double CalculatorBase::prepareReference<Options::SCF_MODES::RESTRICTED>(bool localized,
+                                                                                 const std::string& prefix);
+template double CalculatorBase::prepareReference<Options::SCF_MODES::UNRESTRICTED>(bool localized,
+                                                                                   const std::string& prefix);
+template void CalculatorBase::runScf<Options::SCF_MODES::UNRESTRICTED>();
+template std::shared_ptr<const SerenityState::OrbitalData>
+CalculatorBase::extractOrbitals<Options::SCF_MODES::RESTRICTED>(const std::shared_ptr<SystemController>& system);
+template std::shared_ptr<const SerenityState::OrbitalData>
+CalculatorBase::extractOrbitals<Options::SCF_MODES::UNRESTRICTED>(const std::shared_ptr<SystemController>& system);
+template void CalculatorBase::applyOrbitals<Options::SCF_MODES::RESTRICTED>(const SerenityState::OrbitalData& data,
+                                                                           const std::shared_ptr<SystemController>& system);
+template void CalculatorBase::applyOrbitals<Options::SCF_MODES::UNRESTRICTED>(const SerenityState::OrbitalData& data,
+                                                                             const std::shared_ptr<SystemController>& system);
+template std::shared_ptr<SystemController>
+CalculatorBase::displacedSystem<Options::SCF_MODES::RESTRICTED>(const Eigen::MatrixXd& coordinates,
+                                                                std::shared_ptr<const ScratchManager::Directory>& scratch) const;
+template std::shared_ptr<SystemController>
+CalculatorBase::displacedSystem<Options::SCF_MODES::UNRESTRICTED>(const Eigen::MatrixXd& coordinates,
+                                                                  std::shared_ptr<const ScratchManager::Directory>& scratch) const;
 
 } /* namespace Serenity */
 } /* namespace Scine */
@@ -7,6 +7,12 @@
 #ifndef SERENITY_CALCULATORBASE_H_
 #define SERENITY_CALCULATORBASE_H_
 
+/* Wrapper Includes */
+#include "Serenity/Calculators/BlockScreening.h"
+#include "Serenity/Calculators/PropertyPlanner.h"
+#include "Serenity/Calculators/ResultCache.h"
+#include "Serenity/Calculators/ScratchManager.h"
+#include "Serenity/Calculators/SerenityState.h"
 /* Serenity Includes */
 #include "data/matrices/DensityMatrix.h"
 #include "settings/Options.h"
@@ -15,10 +21,18 @@
 #include <Utils/CalculatorBasics.h>
 #include <Utils/Settings.h>
 #include <Utils/Technical/CloneInterface.h>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 namespace Serenity {
+class BasisFunctionOnGridController;
 class Geometry;
+struct LocalCorrelationSettings;
 class SystemController;
 template<Options::SCF_MODES ScfMode, class T, typename E>
 class SpinPolarizedData;
@@ -45,7 +59,13 @@ class CalculatorBase : public Scine::Utils::CloneInterface<Scine::Utils::Abstrac
   CalculatorBase();
   /// @brief Default Destructor.
   ~CalculatorBase() override;
-  /// @brief Copy Constructor.
+  /**
+   * @brief Copy Constructor.
+   *
+   * By default the copy starts without a Serenity system. With 'warm_clone' enabled, the copy
+   * shares the geometry (and thereby basis, grid and one-electron integrals) with the original
+   * and starts from its converged orbitals; both detach from each other once either one moves.
+   */
   CalculatorBase(const CalculatorBase& other);
   /**
    * @brief Sets new structure and initializes the underlying method with the parameter given in the settings.
@@ -89,10 +109,46 @@ class CalculatorBase : public Scine::Utils::CloneInterface<Scine::Utils::Abstrac
   virtual Scine::Utils::PropertyList possibleProperties() const override = 0;
   /**
    * @brief The main function running calculations.
+   *
+   * Calculators may be used from several threads, but their calculations are serialized
+   * within the process: Serenity's output settings and std::cout are process globals, so a
+   * calculation waits for those of all other calculators to end (see OutputContext).
+   * Parallel calculations require several processes.
+   *
    * @param dummy   A dummy parameter.
    * @return Scine::Utils::Results Return the result of the calculation.
    */
   const Scine::Utils::Results& calculate(std::string dummy) final;
+  /**
+   * @brief Calculates the required properties for many sets of positions of the current structure.
+   *
+   * The Serenity system (basis, grids, settings) is only set up once for the whole batch.
+   * The geometries are visited in nearest-neighbour order, such that each converged
+   * electronic structure can serve as initial guess for the closest remaining geometry.
+   * Failed calculations are reported per structure (Property::SuccessfulCalculation set to
+   * false, the error in Property::Description) instead of aborting the batch.
+   * The geometries are calculated one after the other in this process, 'displacement_workers'
+   * does not apply to batches.
+   * The results of each structure are moved into the returned vector, hence results() is not
+   * valid during the batch. The positions of the calculator are restored afterwards, which
+   * leaves results() empty (as does any modifyPositions()).
+   * Bound to Python as scine_serenity_wrapper.calculate_batch().
+   *
+   * @param positions The positions, each given in the atom order of the current structure.
+   * @return std::vector<Scine::Utils::Results> The results, in the order of the given positions.
+   */
+  std::vector<Scine::Utils::Results> calculateBatch(const std::vector<Scine::Utils::PositionCollection>& positions);
+  /**
+   * @brief The categories each setting is declared in (see technicalKeys() and the following ones).
+   *
+   * Settings not declared in any category define the system ('system'). Keys declared for
+   * settings this calculator does not have are listed as well, hence a consistent calculator
+   * yields exactly one category for exactly its settings.
+   * Bound to Python as scine_serenity_wrapper.setting_categories().
+   *
+   * @return std::map<std::string, std::vector<std::string>> The categories of each key.
+   */
+  std::map<std::string, std::vector<std::string>> settingCategories() const;
   /**
    * @brief Accessor for the Settings used in this method wrapper.
    * @returns Scine::Utils::Settings& The Settings.
@@ -115,11 +171,23 @@ class CalculatorBase : public Scine::Utils::CloneInterface<Scine::Utils::Abstrac
   const Scine::Utils::Results& results() const final;
   /**
    * @brief Exchange the current state/system for a different one.
+   *
+   * The current system is kept if the state describes the same atoms, only the
+   * coordinates and orbitals are replaced.
+   *
    * @param state The new state/system.
    */
   void loadState(std::shared_ptr<Scine::Core::State> state) final;
   /**
    * @brief Get a copy of current state/system.
+   *
+   * The orbitals are shared with the calculator (and all other states taken since the last
+   * SCF), they are only copied once after each SCF. After a calculation served entirely by the
+   * result cache, the orbitals belong to the geometry of the last SCF; the state then holds
+   * none instead of mismatching ones. If the orbitals held only by the states of this
+   * calculator exceed the 'state_memory_limit', the least recently taken of these states are
+   * written to disk until the limit is met; the orbitals shared with the calculator stay in memory.
+   *
    * @return std::shared_ptr<Scine::Core::State> The current state/system.
    */
   std::shared_ptr<Scine::Core::State> getState() const final;
@@ -130,15 +198,72 @@ class CalculatorBase : public Scine::Utils::CloneInterface<Scine::Utils::Abstrac
   bool allowsPythonGILRelease() const override {
     return true;
   };
+  /**
+   * @brief Getter for the planner, which knows the work items recomputed and reused in the last
+   *        calculation (also reported in Property::Description).
+   */
+  const PropertyPlanner& getPlanner() const {
+    return _planner;
+  }
+  /**
+   * @brief Removes all results kept for repeated calculations of the same positions.
+   *
+   * The cache holds the results of the last 'result_cache_size' geometries, keyed by the
+   * elements, the exact positions and all settings affecting results. Revisiting a cached
+   * geometry returns the cached properties without an SCF if all required properties are
+   * present, otherwise only the missing ones are calculated. Such hits leave the electronic
+   * structure untouched, states taken afterwards hold no orbitals (see getState()).
+   * The cache is off by default, setting 'result_cache_size' to 0 clears it as well.
+   */
+  void clearResultCache();
+  /// @brief The settings of local correlation methods (DLPNO thresholds), never affecting the system.
+  static const std::set<std::string>& localCorrelationKeys();
+  /**
+   * @brief Getter for the screened sparse (CSR) form of a matrix property of the last calculation.
+   *
+   * With 'sparse_matrix_threshold' > 0, the required DensityMatrix (the total density and, if
+   * unrestricted, the alpha and beta densities) and OverlapMatrix are screened by atom blocks
+   * and replaced: the results no longer hold the dense matrices, only this getter
+   * (scine_serenity_wrapper.screened_matrix() in Python) provides them. The BondOrderMatrix is
+   * pruned elementwise within the results instead. The retained fraction and the largest
+   * discarded element of each one are reported in Property::Description.
+   *
+   * Dropping these required properties deliberately breaks the Core::Calculator contract that
+   * the results hold all required properties. The screening is opt-in for callers reading the
+   * matrices through this getter; generic callers relying on the contract have to keep the
+   * threshold at 0. The result cache always holds the dense matrices.
+   *
+   * @param property Either DensityMatrix or OverlapMatrix.
+   * @param spin     "total", or "alpha" or "beta" for the DensityMatrix of unrestricted calculations.
+   * @return const ScreenedMatrix& The screened matrix.
+   * @throws std::runtime_error If the last calculation did not screen the property.
+   */
+  const ScreenedMatrix& getScreenedMatrix(Scine::Utils::Property property, const std::string& spin = "total") const;
 
  protected:
   std::unique_ptr<ScineSettings> _settings;
   std::unique_ptr<Scine::Utils::Results> _results;
   Scine::Utils::PropertyList _requiredProperties;
+  /// @brief The scratch directory of _system, declared first in order to outlive it.
+  std::shared_ptr<const ScratchManager::Directory> _scratch;
   std::shared_ptr<Sty::SystemController> _system;
   std::shared_ptr<Sty::Geometry> _geometry;
   std::unique_ptr<Scine::Utils::PositionCollection> _scinePositions;
-  bool _moved;
+  /// @brief The work items up to date for the current geometry and settings.
+  PropertyPlanner _planner;
+  /// @brief The orbitals of the current system as shared with states, nullptr if not taken yet.
+  mutable std::shared_ptr<const SerenityState::OrbitalData> _restrictedSnapshot;
+  /// @brief The orbitals of the current system as shared with states, nullptr if not taken yet.
+  mutable std::shared_ptr<const SerenityState::OrbitalData> _unrestrictedSnapshot;
+  /// @brief The states taken from this calculator, spilled beyond the 'state_memory_limit'.
+  mutable SerenityState::Tracker _stateTracker;
+  /// @brief Whether _geometry is shared with a warm clone (or its original).
+  mutable bool _sharesGeometry;
+  /**
+   * @brief Key-value information about the last calculation (e.g. the SCF guess used),
+   *        reported as Property::Description in the form 'key=value; ...'.
+   */
+  std::map<std::string, std::string> _calculationLog;
 
   /**
    * @brief Apply all settings required to be a fixed value as determined by the Calculator type.
@@ -168,16 +293,293 @@ class CalculatorBase : public Scine::Utils::CloneInterface<Scine::Utils::Abstrac
    * @brief The available solvation models for each implementation
    */
   virtual std::vector<std::string> availableSolvationModels() const = 0;
+  /**
+   * @brief The settings of the wrapper itself (output, scratch, parallelization, caches).
+   *
+   * They affect neither the system nor the values of any result; changing them invalidates
+   * nothing and keeps the result cache. Each setting belongs to at most one of these
+   * categories (technical, convergence, charges, gradients, thermochemistry, correlation),
+   * all others define the system (see settingCategories()).
+   */
+  virtual std::set<std::string> technicalKeys() const;
+  /**
+   * @brief The settings only affecting the guess and the convergence path (e.g. adaptive thresholds).
+   *
+   * Changing them keeps the system, results may differ within the convergence thresholds.
+   */
+  virtual std::set<std::string> convergenceKeys() const;
+  /// @brief The settings only affecting the atomic charges, changing them only invalidates those.
+  virtual std::set<std::string> chargeKeys() const;
+  /// @brief The settings only affecting the gradients, changing them only invalidates those.
+  virtual std::set<std::string> gradientKeys() const {
+    return {};
+  }
+  /// @brief The settings only affecting the thermochemistry, changing them only invalidates it.
+  virtual std::set<std::string> thermochemistryKeys() const;
+  /**
+   * @brief The settings only affecting a correlation treatment on top of the SCF.
+   *
+   * Changing them keeps the system and only invalidates the energy (and the items depending
+   * on it); the implementation is expected to reuse its reference orbitals then.
+   */
+  virtual std::set<std::string> correlationKeys() const {
+    return {};
+  }
+  /**
+   * @brief Applies the 'dlpno_accuracy' preset and the explicitly given DLPNO thresholds.
+   * @param settings The local correlation settings of a Serenity correlation task.
+   */
+  void applyLocalCorrelationSettings(Sty::LocalCorrelationSettings& settings) const;
+  /// @brief Localizes the occupied orbitals of a system (IBO) for local correlation methods.
+  static void localizeOrbitals(const std::shared_ptr<Sty::SystemController>& system);
+  /**
+   * @brief Prepares the HF reference of a correlation calculation on the current system.
+   *
+   * The HF reference and the localized orbitals are kept as stages: as long as the structure
+   * and the electronic structure stay those left by the last call, the reference (and, once
+   * generated, the localized orbitals) is reused, otherwise the SCF is rerun. Afterwards the
+   * orbitals of the requested kind are present in the system. Stage reuse and the localization
+   * time are reported as '<prefix>_reference', '<prefix>_localization' and 'localization_time'.
+   *
+   * @param localized Whether the correlation step runs on IBO-localized orbitals.
+   * @param prefix    The prefix of the reported stages, e.g. 'cc'.
+   * @return double The HF energy.
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  double prepareReference(bool localized, const std::string& prefix);
 
+  /// @brief Converts a Serenity density matrix, copying it exactly once.
   template<Sty::Options::SCF_MODES ScfMode>
-  Scine::Utils::DensityMatrix convertDensityMatrix(Sty::DensityMatrix<ScfMode> dmat,
-                                                   Sty::SpinPolarizedData<ScfMode, unsigned int, void> nEl) const;
+  Scine::Utils::DensityMatrix convertDensityMatrix(const Sty::DensityMatrix<ScfMode>& dmat,
+                                                   const Sty::SpinPolarizedData<ScfMode, unsigned int, void>& nEl) const;
   template<Sty::Options::SCF_MODES ScfMode>
   std::vector<double> getMullikenCharges() const;
+  /// @brief The atomic charges of the model chosen in the settings ('atomic_charge_model').
+  template<Sty::Options::SCF_MODES ScfMode>
+  std::vector<double> getAtomicCharges() const;
+  /**
+   * @brief Checks whether a work item is still up to date (and its results are present).
+   * @param item The work item.
+   * @return bool Whether the item can be skipped, it is then reported as reused.
+   */
+  bool reuse(PropertyPlanner::Item item);
+  /// @brief Sets the properties derived from the basis and the one-electron integrals alone.
+  void setIntegralProperties();
+  /// @brief Sets the density matrix and the electronic occupation.
+  template<Sty::Options::SCF_MODES ScfMode>
+  void setDensityProperties();
+  /// @brief Derives a property (bond orders, thermochemistry) from the present results.
+  void completeProperty(Scine::Utils::Property property);
+  /// @brief The results of the previous calculation, during a calculation.
+  std::unique_ptr<Scine::Utils::Results> _previousResults;
+  /// @brief The cached results of the current positions, during a calculation.
+  std::shared_ptr<const Scine::Utils::Results> _cachedResults;
+  /// @brief Whether _cachedResults contains the outputs of all work items of the calculation.
+  bool _cacheCoversPlan = false;
+  /// @brief Whether the orbitals of the system belong to another geometry, as after a calculation served by the cache.
+  mutable bool _staleOrbitals = false;
   template<Sty::Options::SCF_MODES ScfMode>
   std::vector<double> getHirshfeldCharges() const;
+  /**
+   * @brief Runs the SCF of the current system.
+   *
+   * The orbitals of previous geometries serve as guess as selected by 'guess_extrapolation':
+   * 'none' reuses the last orbitals as they are, 'projected' orthonormalizes them in the basis
+   * of the new geometry and 'aspc' extrapolates the orbitals of the last few geometries with the
+   * predictor of Kolafa's always stable predictor-corrector (the SCF itself being the corrector).
+   * If the last occupied orbitals are close to linearly dependent at the new geometry
+   * (see 'guess_min_overlap'), Serenity's initial guess is used instead.
+   * Without any previous orbitals, the 'guess_cache_directory' (if set) is searched for the
+   * orbitals of the same or a nearby geometry; converged orbitals are added to that cache.
+   * With 'adaptive_scf_threshold', the thresholds may be loosened far from stationary points
+   * unless a Hessian is requested; results and orbitals of such an SCF are neither reused by
+   * later calculations nor cached.
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  void runScf();
+  /**
+   * @brief The Serenity settings of the current system with the SCF thresholds requested by the user.
+   *
+   * The system itself may run on thresholds loosened by runScf(), systems derived from it
+   * use these settings instead.
+   */
+  Sty::Settings systemSettings() const;
+
+  /// @brief Evaluates the gradients of a system with a converged electronic structure.
+  using GradientFunction = std::function<Eigen::MatrixXd(const std::shared_ptr<Sty::SystemController>&)>;
+  /**
+   * @brief Calculates the Hessian of the current system by finite differences of gradients.
+   *
+   * With a single displacement worker Serenity's NumericalHessianCalc is used, otherwise the
+   * displaced gradient calculations are distributed by runDisplacements().
+   *
+   * @param gradients The function evaluating the gradients of each displaced system,
+   *                  only used if no worker processes are available.
+   * @return Eigen::MatrixXd The Hessian.
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  Eigen::MatrixXd calculateHessian(const GradientFunction& gradients) const;
+  /**
+   * @brief Runs the work items planned for the required properties, skipping those still up to date.
+   *
+   * Only the energy and the gradients are specific to a calculator, all other items are derived
+   * from the electronic structure of the current system.
+   *
+   * @param energy           Calculates the energy of the current system and its electronic structure.
+   * @param gradients        Evaluates the gradients of the current system.
+   * @param displacedSystems Whether the gradients can also be evaluated for other (displaced) systems,
+   *                         as required for Hessians.
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  void runPlannedItems(const std::function<double()>& energy, const GradientFunction& gradients, bool displacedSystems);
+  /**
+   * @brief The displaced positions of central finite differences.
+   * @param step The displacement (in bohr).
+   * @return std::vector<Eigen::MatrixXd> The positions 2i and 2i+1, displaced by +step and -step
+   *                                      along the i-th (atom-wise) Cartesian coordinate.
+   */
+  std::vector<Eigen::MatrixXd> centralDisplacements(double step) const;
+  /**
+   * @brief Calculates the energies or gradients of displaced copies of the current structure.
+   *
+   * With several 'displacement_workers' each worker process sets up a calculator of the same
+   * kind from the current settings and starts from the current orbitals (see DisplacementJob).
+   * Settings depending on the history of this calculator (adaptive grid and SCF thresholds, the
+   * guess extrapolation, the caches) are pinned to their current effect. Without worker
+   * processes the given task is run for each displacement in this process.
+   *
+   * @param positions The positions of each displaced structure.
+   * @param gradients Whether the gradients (flattened atom-wise) are calculated instead of the energies.
+   * @param task      The evaluation of a displaced structure in this process, given its index.
+   * @return Eigen::MatrixXd The results, one row per displaced structure.
+   */
+  Eigen::MatrixXd runDisplacements(const std::vector<Eigen::MatrixXd>& positions, bool gradients,
+                                   const std::function<Eigen::VectorXd(unsigned int)>& task) const;
+  /**
+   * @brief Generates a copy of the current system at different coordinates.
+   *
+   * The copy uses the same Serenity settings (see systemSettings(), but a unique name) and
+   * starts from the electronic structure of the current system, if there is one.
+   *
+   * @param coordinates The new coordinates.
+   * @param scratch     Returns the scratch directory of the copy, which must not outlive it.
+   * @return std::shared_ptr<Sty::SystemController> The displaced system.
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  std::shared_ptr<Sty::SystemController> displacedSystem(const Eigen::MatrixXd& coordinates,
+                                                         std::shared_ptr<const ScratchManager::Directory>& scratch) const;
+  /// @brief Encodes all settings the system depends on.
+  std::string systemFingerprint() const;
+  /**
+   * @brief Generates a system in a scratch directory of its own.
+   * @param geometry The geometry.
+   * @param settings The Serenity settings, path and name are replaced.
+   * @param scratch  Returns the scratch directory of the system, which must not outlive it.
+   * @return std::shared_ptr<Sty::SystemController> The new system.
+   */
+  std::shared_ptr<Sty::SystemController> createSystem(std::shared_ptr<Sty::Geometry> geometry, Sty::Settings settings,
+                                                      std::shared_ptr<const ScratchManager::Directory>& scratch) const;
+  /// @brief Copies the orbitals (coefficients, eigenvalues, occupations) of a system.
+  template<Sty::Options::SCF_MODES ScfMode>
+  static std::shared_ptr<const SerenityState::OrbitalData> extractOrbitals(const std::shared_ptr<Sty::SystemController>& system);
+  /// @brief Replaces the electronic structure of a system by one built from the given orbitals.
+  template<Sty::Options::SCF_MODES ScfMode>
+  static void applyOrbitals(const SerenityState::OrbitalData& data, const std::shared_ptr<Sty::SystemController>& system);
 
  private:
+  /**
+   * @brief Replaces a geometry shared with a warm clone by a private copy (and rebuilds the
+   *        system on top of it), such that moving the atoms does not affect the other calculator.
+   */
+  void detachGeometry();
+  /**
+   * @brief Replaces the electronic structure of the current system by the guess for runScf().
+   * @return std::string The kind of guess used.
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  std::string prepareGuess();
+  /**
+   * @brief Loads orbitals from the 'guess_cache_directory' into the current system.
+   * @return bool Whether orbitals were found.
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  bool loadCachedGuess();
+  /**
+   * @brief The key of the current system in the guess cache: reference method (and functional),
+   *        basis, charge, spin, SCF mode and elements, but not the positions.
+   */
+  std::string guessCacheKey() const;
+  /// @brief The progress of the 'adaptive_grid' mode.
+  struct GridStage {
+    /// @brief Whether the final grid (grid_accuracy) is used, otherwise grid_smallGridAccuracy.
+    bool final = false;
+    double lastEnergy = std::numeric_limits<double>::quiet_NaN();
+    /// @brief The energy change between the last two geometries.
+    double energyChange = std::numeric_limits<double>::infinity();
+    double gradientNorm = std::numeric_limits<double>::infinity();
+  };
+  GridStage _gridStage;
+  /// @brief The largest absolute gradient component of the last calculation of gradients.
+  double _lastMaxGradient = std::numeric_limits<double>::infinity();
+  /// @brief Whether the last SCF ran on thresholds loosened by 'adaptive_scf_threshold'.
+  bool _scfLoosened = false;
+  /// @brief The stages of the last correlation calculation, see prepareReference().
+  struct CorrelationReference {
+    std::weak_ptr<Sty::SystemController> system;
+    /// @brief The electronic structure of the system after the last call.
+    std::weak_ptr<const void> electronicStructure;
+    Eigen::MatrixXd positions;
+    double hfEnergy = 0.0;
+    std::shared_ptr<const SerenityState::OrbitalData> canonical;
+    std::shared_ptr<const SerenityState::OrbitalData> localized;
+    /// @brief The orbitals currently present in the system.
+    std::shared_ptr<const SerenityState::OrbitalData> current;
+  };
+  CorrelationReference _correlationReference;
+  /// @brief Sets the grid accuracy of the current stage of the 'adaptive_grid' mode.
+  void applyGridStage(Sty::Settings& settings) const;
+  /// @brief Switches to the final grid once the thresholds of the 'adaptive_grid' mode are met.
+  void refineGrid();
+  /// @brief Records the energy and gradient norm of the last calculation for refineGrid().
+  void trackGridConvergence();
+  /// @brief Leases the integral engines needed for the required properties from the LibintEnginePool.
+  void leaseEngines();
+  /// @brief The screened matrix properties of the last calculation, not copied into clones.
+  std::map<std::pair<Scine::Utils::Property, std::string>, ScreenedMatrix> _screenedMatrices;
+  /// @brief Screens the matrix properties of the results if 'sparse_matrix_threshold' is set.
+  void screenMatrices();
+  /// @brief The results of the last geometries, not copied into clones.
+  ResultCache _resultCache;
+  /// @brief The key of the current structure and settings in the result cache, everything but the positions.
+  std::string resultCacheKey() const;
+  /// @brief The integral engines kept for this calculator.
+  std::vector<std::shared_ptr<const void>> _engines;
+  /// @brief Comma separated names of work items, 'none' if empty.
+  static std::string itemNames(const std::vector<PropertyPlanner::Item>& items);
+  /**
+   * @brief Encodes the values of a subset of the settings.
+   * @param keys The settings to encode.
+   * @param complement If true, all settings except the given ones are encoded.
+   */
+  std::string settingsFingerprint(const std::set<std::string>& keys, bool complement = false) const;
+  /// @brief The settings the current system was set up with.
+  std::string _systemFingerprint;
+  /// @brief The settings the current correlation energy was calculated with.
+  std::string _correlationFingerprint;
+  /// @brief The settings the current atomic charges were calculated with.
+  std::string _chargeFingerprint;
+  /// @brief The settings the current gradients were calculated with.
+  std::string _gradientFingerprint;
+  /// @brief The settings the current thermochemistry was calculated with.
+  std::string _thermochemistryFingerprint;
+  /// @brief The basis functions on the grid of _chargeGridSystem, kept for further Hirshfeld charges.
+  mutable std::shared_ptr<Sty::BasisFunctionOnGridController> _chargeGridFunctions;
+  mutable std::weak_ptr<Sty::SystemController> _chargeGridSystem;
+  /// @brief The converged orbitals of the last geometries (oldest first), only kept for 'aspc'.
+  std::deque<std::shared_ptr<const SerenityState::OrbitalData>> _guessHistory;
+  template<Sty::Options::SCF_MODES ScfMode>
+  static void copyElectronicStructure(const std::shared_ptr<Sty::SystemController>& source,
+                                      const std::shared_ptr<Sty::SystemController>& target);
   template<Sty::Options::SCF_MODES ScfMode>
   std::vector<double> populationToCharges(const Sty::SpinPolarizedData<ScfMode, Eigen::VectorXd>& populations) const;
   inline static double
@@ -71,6 +71,10 @@ class DFTCalculator : public Scine::Utils::CloneInterface<DFTCalculator, Calcula
   inline std::vector<std::string> availableSolvationModels() const final {
     return {"cpcm", "iefpcm"};
   }
+
+ private:
+  template<Sty::Options::SCF_MODES ScfMode>
+  Eigen::MatrixXd calculateGradients(const std::shared_ptr<Sty::SystemController>& system) const;
 };
 
 } /* namespace Serenity */
@@ -0,0 +1,212 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+/* Wrapper Includes */
+#include "Serenity/Calculators/DisplacementJob.h"
+#include "Serenity/Calculators/CCCalculator.h"
+#include "Serenity/Calculators/DFTCalculator.h"
+#include "Serenity/Calculators/EmbeddingCalculator.h"
+#include "Serenity/Calculators/HFCalculator.h"
+#include "Serenity/Calculators/MP2Calculator.h"
+#include "Serenity/Calculators/SerenityState.h"
+/* Scine Includes */
+#include <Core/Exceptions.h>
+#include <Core/Interfaces/Calculator.h>
+#include <Utils/CalculatorBasics.h>
+#include <Utils/Settings.h>
+#include <Utils/Typenames.h>
+/* External Includes */
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace Scine {
+namespace Serenity {
+
+namespace {
+void writeString(std::ofstream& out, const std::string& value) {
+  const auto length = static_cast<unsigned int>(value.size());
+  out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+  out.write(value.data(), length);
+}
+
+std::string readString(std::ifstream& in) {
+  unsigned int length = 0;
+  in.read(reinterpret_cast<char*>(&length), sizeof(length));
+  std::string value(length, ' ');
+  in.read(&value[0], length);
+  return value;
+}
+
+std::shared_ptr<Scine::Core::Calculator> makeCalculator(const std::string& name) {
+  if (name == "SerenityDFTCalculator") {
+    return std::make_shared<DFTCalculator>();
+  }
+  if (name == "SerenityHFCalculator") {
+    return std::make_shared<HFCalculator>();
+  }
+  if (name == "SerenityCCCalculator") {
+    return std::make_shared<CCCalculator>();
+  }
+  if (name == "SerenityMP2Calculator") {
+    return std::make_shared<MP2Calculator>();
+  }
+  if (name == "SerenityEmbeddingCalculator") {
+    return std::make_shared<EmbeddingCalculator>();
+  }
+  throw std::runtime_error("Unknown calculator '" + name + "' in a displacement job.");
+}
+} // namespace
+
+void DisplacementJob::write(const std::string& file, const std::string& calculator, const Scine::Utils::Settings& settings,
+                            const std::shared_ptr<Scine::Core::State>& reference,
+                            const std::vector<Eigen::MatrixXd>& positions, bool gradients) {
+  auto state = std::dynamic_pointer_cast<SerenityState>(reference);
+  if (!state) {
+    throw Scine::Core::StateCastingException();
+  }
+  state->save(file + ".state");
+  std::ofstream out(file, std::ios::binary | std::ios::trunc);
+  writeString(out, calculator);
+  // Only the value types the calculators use, each with a type tag
+  std::vector<std::string> keys;
+  for (const auto& key : settings.getKeys()) {
+    const auto value = settings.getValue(key);
+    if (value.isBool() || value.isInt() || value.isDouble() || value.isString()) {
+      keys.push_back(key);
+    }
+  }
+  const auto nKeys = static_cast<unsigned int>(keys.size());
+  out.write(reinterpret_cast<const char*>(&nKeys), sizeof(nKeys));
+  for (const auto& key : keys) {
+    const auto value = settings.getValue(key);
+    writeString(out, key);
+    if (value.isBool()) {
+      const char type = 'b';
+      const char flag = value.toBool() ? 1 : 0;
+      out.write(&type, 1);
+      out.write(&flag, 1);
+    }
+    else if (value.isInt()) {
+      const char type = 'i';
+      const int number = value.toInt();
+      out.write(&type, 1);
+      out.write(reinterpret_cast<const char*>(&number), sizeof(number));
+    }
+    else if (value.isDouble()) {
+      const char type = 'd';
+      const double number = value.toDouble();
+      out.write(&type, 1);
+      out.write(reinterpret_cast<const char*>(&number), sizeof(number));
+    }
+    else {
+      const char type = 's';
+      out.write(&type, 1);
+      writeString(out, value.toString());
+    }
+  }
+  const char flag = gradients ? 1 : 0;
+  out.write(&flag, 1);
+  const auto nPositions = static_cast<unsigned int>(positions.size());
+  out.write(reinterpret_cast<const char*>(&nPositions), sizeof(nPositions));
+  for (const auto& p : positions) {
+    const Eigen::MatrixXd::Index rows = p.rows();
+    out.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+    out.write(reinterpret_cast<const char*>(p.data()), rows * 3 * sizeof(double));
+  }
+  out.close();
+  if (!out) {
+    throw std::runtime_error("Failed to write the displacement job '" + file + "'.");
+  }
+}
+
+void DisplacementJob::remove(const std::string& file) {
+  std::remove(file.c_str());
+  std::remove((file + ".state").c_str());
+}
+
+DisplacementJob::DisplacementJob(const std::string& file) {
+  std::ifstream in(file, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("Failed to open the displacement job '" + file + "'.");
+  }
+  _calculator = makeCalculator(readString(in));
+  auto& settings = _calculator->settings();
+  unsigned int nKeys = 0;
+  in.read(reinterpret_cast<char*>(&nKeys), sizeof(nKeys));
+  for (unsigned int i = 0; i < nKeys && in; ++i) {
+    const std::string key = readString(in);
+    char type = 0;
+    in.read(&type, 1);
+    // Settings unknown to this calculator are read but not applied
+    const bool known = settings.valueExists(key);
+    if (type == 'b') {
+      char flag = 0;
+      in.read(&flag, 1);
+      if (known) {
+        settings.modifyBool(key, flag != 0);
+      }
+    }
+    else if (type == 'i') {
+      int number = 0;
+      in.read(reinterpret_cast<char*>(&number), sizeof(number));
+      if (known) {
+        settings.modifyInt(key, number);
+      }
+    }
+    else if (type == 'd') {
+      double number = 0.0;
+      in.read(reinterpret_cast<char*>(&number), sizeof(number));
+      if (known) {
+        settings.modifyDouble(key, number);
+      }
+    }
+    else {
+      const std::string value = readString(in);
+      if (known) {
+        settings.modifyString(key, value);
+      }
+    }
+  }
+  char flag = 0;
+  in.read(&flag, 1);
+  _gradients = (flag != 0);
+  unsigned int nPositions = 0;
+  in.read(reinterpret_cast<char*>(&nPositions), sizeof(nPositions));
+  _positions.resize(nPositions);
+  for (auto& p : _positions) {
+    Eigen::MatrixXd::Index rows = 0;
+    in.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+    p.resize(rows, 3);
+    in.read(reinterpret_cast<char*>(p.data()), rows * 3 * sizeof(double));
+  }
+  if (!in) {
+    throw std::runtime_error("Failed to read the displacement job '" + file + "'.");
+  }
+  _reference = SerenityState::load(file + ".state");
+  if (_gradients) {
+    _calculator->setRequiredProperties(Scine::Utils::Property::Energy | Scine::Utils::Property::Gradients);
+  }
+  else {
+    _calculator->setRequiredProperties(Scine::Utils::Property::Energy);
+  }
+}
+
+Eigen::VectorXd DisplacementJob::run(unsigned int task) {
+  // Every displacement starts from the orbitals of the reference
+  _calculator->loadState(_reference);
+  _calculator->modifyPositions(Scine::Utils::PositionCollection(_positions.at(task)));
+  const auto& results = _calculator->calculate("");
+  if (!_gradients) {
+    return Eigen::VectorXd::Constant(1, results.get<Scine::Utils::Property::Energy>());
+  }
+  // Flattened atom-wise (x1, y1, z1, x2, ...)
+  const Scine::Utils::GradientCollection& gradients = results.get<Scine::Utils::Property::Gradients>();
+  return Eigen::Map<const Eigen::VectorXd>(gradients.data(), gradients.size());
+}
+
+} /* namespace Serenity */
+} /* namespace Scine */
@@ -0,0 +1,76 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef SERENITY_DISPLACEMENTJOB_H_
+#define SERENITY_DISPLACEMENTJOB_H_
+
+/* External Includes */
+#include <Eigen/Dense>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Scine {
+namespace Core {
+class Calculator;
+class State;
+} // namespace Core
+namespace Utils {
+class Settings;
+} // namespace Utils
+namespace Serenity {
+
+/**
+ * @brief The displaced calculations handed to the worker processes of a DisplacementWorkerPool.
+ *
+ * A job file holds the calculator (by name), its settings, the reference state (in
+ * '<file>.state') and the positions of all displaced structures. Each worker sets up a
+ * calculator of its own from it and starts every displaced calculation from the orbitals
+ * of the reference state.
+ */
+class DisplacementJob {
+ public:
+  /**
+   * @brief Writes a job file.
+   * @param file       The job file.
+   * @param calculator The name() of the calculator.
+   * @param settings   The settings of the calculators of the workers.
+   * @param reference  The state the displaced calculations start from.
+   * @param positions  The positions of each displaced structure.
+   * @param gradients  Whether the gradients (flattened atom-wise) are calculated instead of the energies.
+   */
+  static void write(const std::string& file, const std::string& calculator, const Scine::Utils::Settings& settings,
+                    const std::shared_ptr<Scine::Core::State>& reference, const std::vector<Eigen::MatrixXd>& positions,
+                    bool gradients);
+  /// @brief Removes a job file written by write().
+  static void remove(const std::string& file);
+  /**
+   * @brief Reads a job file and sets up its calculator.
+   * @param file The job file.
+   */
+  explicit DisplacementJob(const std::string& file);
+  /// @brief The number of displaced structures.
+  unsigned int size() const {
+    return static_cast<unsigned int>(_positions.size());
+  }
+  /**
+   * @brief Calculates one displaced structure.
+   * @param task The index of the displaced structure.
+   * @return Eigen::VectorXd The energy or the gradients.
+   */
+  Eigen::VectorXd run(unsigned int task);
+
+ private:
+  std::shared_ptr<Scine::Core::Calculator> _calculator;
+  std::shared_ptr<Scine::Core::State> _reference;
+  std::vector<Eigen::MatrixXd> _positions;
+  bool _gradients;
+};
+
+} /* namespace Serenity */
+} /* namespace Scine */
+
+#endif /* SERENITY_DISPLACEMENTJOB_H_ */
@@ -0,0 +1,347 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+/* Wrapper Includes */
+#include "Serenity/Calculators/DisplacementWorkerPool.h"
+/* External Includes */
+#include <Core/Exceptions.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
+#ifndef _WIN32
+#  include <cerrno>
+#  include <csignal>
+#  include <dlfcn.h>
+#  include <fcntl.h>
+#  include <spawn.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+extern char** environ;
+#endif
+
+namespace Scine {
+namespace Serenity {
+
+namespace {
+/*
+ * Records of the result files, each one starts with the task index and its state:
+ *  - taskDone:   the number of values and the values
+ *  - taskFailed: the length of the error message and the message
+ */
+constexpr std::int32_t taskDone = 1;
+constexpr std::int32_t taskFailed = 2;
+
+void writeFailure(std::ofstream& out, std::uint32_t task, const std::string& message) {
+  const auto length = static_cast<std::uint32_t>(message.size());
+  out.write(reinterpret_cast<const char*>(&task), sizeof(task));
+  out.write(reinterpret_cast<const char*>(&taskFailed), sizeof(taskFailed));
+  out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+  out.write(message.data(), length);
+  out.flush();
+}
+} // namespace
+
+DisplacementWorkerPool::DisplacementWorkerPool(unsigned int nWorkers, unsigned int nThreadsPerWorker, double timeout)
+  : _nWorkers(std::max(nWorkers, 1u)), _nThreadsPerWorker(nThreadsPerWorker), _timeout(timeout) {
+  if (_nThreadsPerWorker == 0) {
+#ifdef _OPENMP
+    const auto available = static_cast<unsigned int>(omp_get_max_threads());
+#else
+    const unsigned int available = 1;
+#endif
+    _nThreadsPerWorker = std::max(available / _nWorkers, 1u);
+  }
+}
+
+std::string DisplacementWorkerPool::executable() {
+#ifdef _WIN32
+  return "";
+#else
+  const char* given = std::getenv("SCINE_SERENITY_WORKER");
+  if (given && *given) {
+    return (access(given, X_OK) == 0) ? std::string(given) : std::string();
+  }
+  // Installed next to the library holding this function
+  Dl_info info;
+  if (dladdr(reinterpret_cast<void*>(&DisplacementWorkerPool::executable), &info) == 0 || !info.dli_fname) {
+    return "";
+  }
+  const std::string library(info.dli_fname);
+  const auto slash = library.rfind('/');
+  const std::string candidate =
+      ((slash == std::string::npos) ? std::string() : library.substr(0, slash + 1)) + "serenity_displacement_worker";
+  return (access(candidate.c_str(), X_OK) == 0) ? candidate : std::string();
+#endif
+}
+
+bool DisplacementWorkerPool::spawnsWorkers(unsigned int nTasks) const {
+  if (std::min(_nWorkers, nTasks) <= 1) {
+    return false;
+  }
+  if (!executable().empty()) {
+    return true;
+  }
+  // Workers were asked for, warn once per process that they are not available
+  static std::once_flag warned;
+  std::call_once(warned, []() {
+    std::cerr << "Warning: 'displacement_workers' is larger than 1, but the 'serenity_displacement_worker' executable "
+#ifdef _WIN32
+                 "is not supported on this platform"
+#else
+                 "was not found (see 'SCINE_SERENITY_WORKER')"
+#endif
+                 "; the displaced calculations are run serially."
+              << std::endl;
+  });
+  return false;
+}
+
+Eigen::MatrixXd DisplacementWorkerPool::run(unsigned int nTasks, unsigned int resultSize, const Task& task) const {
+  Eigen::MatrixXd results(nTasks, resultSize);
+  for (unsigned int i = 0; i < nTasks; ++i) {
+    Eigen::VectorXd result = task(i);
+    if (result.size() != resultSize) {
+      throw Core::UnsuccessfulCalculationException("Displacement task returned a result of unexpected size.");
+    }
+    results.row(i) = result.transpose();
+  }
+  return results;
+}
+
+int DisplacementWorkerPool::serve(const std::string& results, unsigned int worker, unsigned int nWorkers,
+                                  unsigned int nTasks, const Task& task) {
+  std::ofstream out(results, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return 1;
+  }
+  for (unsigned int i = worker; i < nTasks; i += nWorkers) {
+    const auto index = static_cast<std::uint32_t>(i);
+    try {
+      const Eigen::VectorXd result = task(i);
+      const auto size = static_cast<std::uint32_t>(result.size());
+      out.write(reinterpret_cast<const char*>(&index), sizeof(index));
+      out.write(reinterpret_cast<const char*>(&taskDone), sizeof(taskDone));
+      out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+      out.write(reinterpret_cast<const char*>(result.data()), size * sizeof(double));
+      out.flush();
+    }
+    catch (const std::exception& e) {
+      // The calculation fails as a whole, the remaining tasks are not worth running
+      writeFailure(out, index, e.what());
+      return 1;
+    }
+    catch (...) {
+      writeFailure(out, index, "Unknown error.");
+      return 1;
+    }
+  }
+  return out ? 0 : 1;
+}
+
+Eigen::MatrixXd DisplacementWorkerPool::run(const std::string& job, unsigned int nTasks, unsigned int resultSize) const {
+#ifdef _WIN32
+  (void)job;
+  (void)nTasks;
+  (void)resultSize;
+  throw Core::UnsuccessfulCalculationException("Displacement worker processes are not supported on this platform.");
+#else
+  using Clock = std::chrono::steady_clock;
+  const std::string program = executable();
+  if (program.empty()) {
+    throw Core::UnsuccessfulCalculationException("The 'serenity_displacement_worker' executable was not found.");
+  }
+  const unsigned int nWorkers = std::min(_nWorkers, nTasks);
+
+  // The environment of this process, with the OpenMP threads of a worker
+  std::vector<std::string> environment;
+  for (char** entry = environ; entry && *entry; ++entry) {
+    const std::string variable(*entry);
+    if (variable.compare(0, 16, "OMP_NUM_THREADS=") != 0) {
+      environment.push_back(variable);
+    }
+  }
+  environment.push_back("OMP_NUM_THREADS=" + std::to_string(_nThreadsPerWorker));
+  std::vector<char*> envp;
+  for (auto& variable : environment) {
+    envp.push_back(&variable[0]);
+  }
+  envp.push_back(nullptr);
+
+  struct Worker {
+    pid_t pid;
+    std::string results;
+    std::string output;
+    Clock::time_point deadline;
+    bool running;
+    /// @brief Whether the exit status is known, false if the worker was reaped elsewhere.
+    bool hasStatus;
+    int status;
+  };
+  std::vector<Worker> workers;
+  std::string error;
+  const auto start = Clock::now();
+  for (unsigned int w = 0; w < nWorkers; ++w) {
+    Worker worker;
+    worker.results = job + ".worker" + std::to_string(w) + ".bin";
+    worker.output = job + ".worker" + std::to_string(w) + ".out";
+    std::remove(worker.results.c_str());
+    const unsigned int nAssigned = (nTasks - w + nWorkers - 1) / nWorkers;
+    worker.deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(_timeout * nAssigned));
+    std::vector<std::string> arguments = {program, job, worker.results, std::to_string(w), std::to_string(nWorkers)};
+    std::vector<char*> argv;
+    for (auto& argument : arguments) {
+      argv.push_back(&argument[0]);
+    }
+    argv.push_back(nullptr);
+    // Both output streams of the worker go into a file next to its results
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, worker.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+    const int spawned = posix_spawn(&worker.pid, program.c_str(), &actions, nullptr, argv.data(), envp.data());
+    posix_spawn_file_actions_destroy(&actions);
+    if (spawned != 0) {
+      for (auto& running : workers) {
+        kill(running.pid, SIGKILL);
+        int status = 0;
+        while (waitpid(running.pid, &status, 0) < 0 && errno == EINTR) {
+        }
+      }
+      throw Core::UnsuccessfulCalculationException("Failed to start a displacement worker process ('" + program + "').");
+    }
+    worker.running = true;
+    worker.hasStatus = false;
+    worker.status = 0;
+    workers.push_back(worker);
+  }
+
+  /*
+   * One thread per worker blocks until it exits, this thread sleeps until one of them
+   * reports or the earliest deadline passes. A worker is only reaped with the mutex held,
+   * hence a worker still marked as running has not been reaped and can safely be killed.
+   */
+  std::mutex mutex;
+  std::condition_variable exited;
+  std::vector<std::thread> waiters;
+  for (auto& worker : workers) {
+    waiters.emplace_back([&mutex, &exited, &worker]() {
+      siginfo_t info;
+      while (waitid(P_PID, static_cast<id_t>(worker.pid), &info, WEXITED | WNOWAIT) < 0 && errno == EINTR) {
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      int status = 0;
+      pid_t finished = 0;
+      while ((finished = waitpid(worker.pid, &status, 0)) < 0 && errno == EINTR) {
+      }
+      // Without a status (reaped elsewhere) the result file tells
+      worker.hasStatus = (finished == worker.pid);
+      worker.status = status;
+      worker.running = false;
+      exited.notify_one();
+    });
+  }
+
+  // Wait for all workers, killing them all once one fails or times out
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    bool failed = false;
+    while (!failed) {
+      bool running = false;
+      auto deadline = Clock::time_point::max();
+      for (unsigned int w = 0; w < nWorkers; ++w) {
+        const auto& worker = workers[w];
+        if (worker.running) {
+          running = true;
+          deadline = std::min(deadline, worker.deadline);
+        }
+        else if (worker.hasStatus && !(WIFEXITED(worker.status) && WEXITSTATUS(worker.status) == 0)) {
+          failed = true;
+          error = "Displacement worker " + std::to_string(w) + " failed, see '" + worker.output + "'.";
+          break;
+        }
+      }
+      if (failed || !running) {
+        break;
+      }
+      if (_timeout <= 0.0) {
+        exited.wait(lock);
+      }
+      else if (exited.wait_until(lock, deadline) == std::cv_status::timeout && Clock::now() >= deadline) {
+        for (unsigned int w = 0; w < nWorkers; ++w) {
+          if (workers[w].running && workers[w].deadline <= deadline) {
+            failed = true;
+            error = "Displacement worker " + std::to_string(w) + " exceeded the timeout of " +
+                    std::to_string(_timeout) + " s per task.";
+            break;
+          }
+        }
+      }
+    }
+    if (failed) {
+      for (const auto& worker : workers) {
+        if (worker.running) {
+          kill(worker.pid, SIGKILL);
+        }
+      }
+    }
+  }
+  for (auto& waiter : waiters) {
+    waiter.join();
+  }
+
+  // Collect the results, a failed task provides the most specific error
+  Eigen::MatrixXd results(nTasks, resultSize);
+  std::vector<bool> done(nTasks, false);
+  for (const auto& worker : workers) {
+    std::ifstream in(worker.results, std::ios::binary);
+    std::uint32_t task = 0;
+    std::int32_t state = 0;
+    std::uint32_t size = 0;
+    while (in.read(reinterpret_cast<char*>(&task), sizeof(task)) && in.read(reinterpret_cast<char*>(&state), sizeof(state)) &&
+           in.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+      if (state == taskFailed) {
+        std::string message(size, ' ');
+        in.read(&message[0], size);
+        error = "Displaced calculation " + std::to_string(task) + " failed: " + message;
+        continue;
+      }
+      Eigen::VectorXd values(size);
+      if (!in.read(reinterpret_cast<char*>(values.data()), size * sizeof(double))) {
+        break;
+      }
+      if (task < nTasks && size == resultSize) {
+        results.row(task) = values.transpose();
+        done[task] = true;
+      }
+    }
+  }
+  const auto nFailed = static_cast<unsigned int>(std::count(done.begin(), done.end(), false));
+  if (nFailed > 0) {
+    throw Core::UnsuccessfulCalculationException(std::to_string(nFailed) + " of " + std::to_string(nTasks) +
+                                                 " displaced calculations failed. " + error);
+  }
+  for (const auto& worker : workers) {
+    std::remove(worker.results.c_str());
+    std::remove(worker.output.c_str());
+  }
+  return results;
+#endif
+}
+
+} /* namespace Serenity */
+} /* namespace Scine */
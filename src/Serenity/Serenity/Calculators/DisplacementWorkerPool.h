@@ -0,0 +1,102 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef SERENITY_DISPLACEMENTWORKERPOOL_H_
+#define SERENITY_DISPLACEMENTWORKERPOOL_H_
+
+/* External Includes */
+#include <Eigen/Dense>
+#include <functional>
+#include <string>
+
+namespace Scine {
+namespace Serenity {
+
+/**
+ * @brief Evaluates independent displaced-geometry tasks on a pool of worker processes.
+ *
+ * Serenity keeps its integral engines and output options in process-global state,
+ * hence two calculations can not safely run side by side in one process. A forked copy
+ * of the calling process is no way out either: it inherits locks, threads and the OpenMP
+ * runtime in whatever state they are in. Each worker is therefore a fresh process running
+ * the 'serenity_displacement_worker' executable on a job file (see DisplacementJob).
+ * Worker i runs the tasks i, i + nWorkers, ... and appends their results to a file of
+ * its own. Workers exceeding the timeout are killed, as are all others once one fails.
+ *
+ * The executable is looked up in 'SCINE_SERENITY_WORKER' and next to the library
+ * holding this class. With a single worker, without the executable (or on Windows) all
+ * tasks are run serially in the calling process instead; the latter two print a warning
+ * once per process.
+ */
+class DisplacementWorkerPool {
+ public:
+  /// @brief A single task, receives the task index and returns its result vector.
+  using Task = std::function<Eigen::VectorXd(unsigned int)>;
+  /**
+   * @brief Construct a new DisplacementWorkerPool.
+   * @param nWorkers          The number of concurrently running workers.
+   * @param nThreadsPerWorker The number of OpenMP threads each worker uses,
+   *                          0 splits the available threads evenly among the workers.
+   * @param timeout           The wall time (in seconds) allowed per task, 0 waits forever.
+   */
+  DisplacementWorkerPool(unsigned int nWorkers, unsigned int nThreadsPerWorker, double timeout);
+  /**
+   * @brief Whether the tasks are run by worker processes.
+   *
+   * Warns (once per process) if several workers were asked for, but none can be started.
+   *
+   * @param nTasks The number of tasks.
+   */
+  bool spawnsWorkers(unsigned int nTasks) const;
+  /**
+   * @brief Runs all tasks of a job file on the worker processes and collects their results.
+   * @param job        The job file, also the prefix of the result and output files of the workers.
+   * @param nTasks     The number of tasks.
+   * @param resultSize The number of values each task returns.
+   * @return Eigen::MatrixXd The results, one row per task.
+   * @throws Core::UnsuccessfulCalculationException If a task failed or a worker timed out.
+   */
+  Eigen::MatrixXd run(const std::string& job, unsigned int nTasks, unsigned int resultSize) const;
+  /**
+   * @brief Runs all tasks serially in the calling process.
+   * @param nTasks     The number of tasks.
+   * @param resultSize The number of values each task returns.
+   * @param task       The task to be run for each index in [0, nTasks).
+   * @return Eigen::MatrixXd The results, one row per task.
+   */
+  Eigen::MatrixXd run(unsigned int nTasks, unsigned int resultSize, const Task& task) const;
+  /**
+   * @brief The main loop of a worker process.
+   * @param results  The result file of this worker.
+   * @param worker   The index of this worker.
+   * @param nWorkers The number of workers.
+   * @param nTasks   The number of tasks.
+   * @param task     The task to be run for each index assigned to this worker.
+   * @return int The exit code, non-zero once a task failed.
+   */
+  static int serve(const std::string& results, unsigned int worker, unsigned int nWorkers, unsigned int nTasks,
+                   const Task& task);
+  /// @brief Getter for the number of workers.
+  unsigned int getNWorkers() const {
+    return _nWorkers;
+  }
+  /// @brief Getter for the number of OpenMP threads used by each worker.
+  unsigned int getNThreadsPerWorker() const {
+    return _nThreadsPerWorker;
+  }
+
+ private:
+  /// @brief The worker executable, empty if not found.
+  static std::string executable();
+  unsigned int _nWorkers;
+  unsigned int _nThreadsPerWorker;
+  double _timeout;
+};
+
+} /* namespace Serenity */
+} /* namespace Scine */
+
+#endif /* SERENITY_DISPLACEMENTWORKERPOOL_H_ */
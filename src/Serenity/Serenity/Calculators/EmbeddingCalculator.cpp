@@ -0,0 +1,240 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#include "Serenity/Calculators/EmbeddingCalculator.h"
+#include "Serenity/Calculators/ScineSettings.h"
+/* Serenity Includes */
+#include <data/ElectronicStructure.h>
+#include <energies/EnergyContributions.h>
+#include <geometry/Geometry.h>
+#include <settings/Settings.h>
+#include <system/SystemController.h>
+#include <tasks/FDETask.h>
+#include <tasks/FreezeAndThawTask.h>
+#include <tasks/GradientTask.h>
+#include <tasks/ScfTask.h>
+/* Scine Includes */
+#include <Utils/CalculatorBasics.h>
+#include <Utils/Geometry.h>
+#include <Utils/Typenames.h>
+#include <Utils/UniversalSettings/SettingsNames.h>
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <sstream>
+
+namespace Sty = Serenity;
+
+namespace Scine {
+namespace Serenity {
+
+EmbeddingCalculator::EmbeddingCalculator() {
+  this->_settings = std::make_unique<ScineSettings>(std::vector<ScineSettings::Group>{ScineSettings::Group::Embedding});
+}
+
+std::string EmbeddingCalculator::name() const {
+  return "SerenityEmbeddingCalculator";
+}
+
+Scine::Utils::PropertyList EmbeddingCalculator::possibleProperties() const {
+  Scine::Utils::PropertyList properties = Scine::Utils::Property::Energy | Scine::Utils::Property::OverlapMatrix |
+                                          Scine::Utils::Property::AOtoAtomMapping | Scine::Utils::Property::OneElectronMatrix;
+  // A frozen environment density is not variational, the gradients would not belong to the energy
+  if (_settings->getString("embedding_mode") == "freeze_and_thaw") {
+    properties.addProperty(Scine::Utils::Property::Gradients);
+  }
+  return properties;
+}
+
+void EmbeddingCalculator::applyFixedSettings(Sty::Settings& settings) const {
+  settings.method = Sty::Options::ELECTRONIC_STRUCTURE_THEORIES::DFT;
+  auto methodInput = Scine::Utils::CalculationRoutines::splitIntoMethodAndDispersion(
+      this->_settings->getString(Scine::Utils::SettingsNames::method));
+  Sty::Options::resolve(methodInput.first, settings.dft.functional);
+  if (!methodInput.second.empty()) {
+    Sty::Options::resolve(methodInput.second, settings.dft.dispersion);
+  }
+}
+
+std::vector<unsigned int> EmbeddingCalculator::activeAtoms() const {
+  const auto nAtoms = static_cast<unsigned int>(_scinePositions->rows());
+  std::set<unsigned int> atoms;
+  std::stringstream list(_settings->getString("embedding_active_atoms"));
+  std::string entry;
+  while (std::getline(list, entry, ',')) {
+    if (entry.find_first_not_of(' ') == std::string::npos) {
+      continue;
+    }
+    const auto dash = entry.find('-');
+    unsigned long first = 0;
+    unsigned long last = 0;
+    try {
+      first = std::stoul(entry.substr(0, dash));
+      last = (dash == std::string::npos) ? first : std::stoul(entry.substr(dash + 1));
+    }
+    catch (const std::logic_error&) {
+      throw std::runtime_error("Invalid entry '" + entry + "' in 'embedding_active_atoms'.");
+    }
+    if (first > last || last >= nAtoms) {
+      throw std::runtime_error("The entry '" + entry + "' in 'embedding_active_atoms' is out of range.");
+    }
+    for (auto atom = first; atom <= last; ++atom) {
+      atoms.insert(static_cast<unsigned int>(atom));
+    }
+  }
+  if (atoms.empty()) {
+    throw std::runtime_error("No active atoms given in 'embedding_active_atoms'.");
+  }
+  if (atoms.size() == nAtoms) {
+    throw std::runtime_error("All atoms are active, the embedding requires an environment.");
+  }
+  return std::vector<unsigned int>(atoms.begin(), atoms.end());
+}
+
+std::set<std::string> EmbeddingCalculator::correlationKeys() const {
+  return {"embedding_active_atoms", "embedding_mode", "embedding_environment_charge",
+          "embedding_environment_spin_multiplicity", "embedding_max_cycles", "embedding_convergence"};
+}
+
+bool EmbeddingCalculator::updateSubsystem(Subsystem& subsystem, const std::vector<unsigned int>& atoms, int charge, int spin) {
+  const Eigen::MatrixXd all = _geometry->getCoordinates();
+  Eigen::MatrixXd positions(atoms.size(), 3);
+  for (unsigned int i = 0; i < atoms.size(); ++i) {
+    positions.row(i) = all.row(atoms[i]);
+  }
+  if (subsystem.system && subsystem.atoms == atoms && subsystem.charge == charge && subsystem.spin == spin) {
+    if (subsystem.positions == positions) {
+      return true;
+    }
+    // The electronic structure of the old positions serves as guess
+    subsystem.system->getGeometry()->setCoordinates(positions);
+    subsystem.positions = positions;
+    return false;
+  }
+  const auto symbols = _geometry->getAtomSymbols();
+  std::vector<std::string> subsystemSymbols;
+  for (const auto atom : atoms) {
+    subsystemSymbols.push_back(symbols[atom]);
+  }
+  auto settings = this->systemSettings();
+  settings.charge = charge;
+  settings.spin = spin;
+  subsystem = Subsystem();
+  subsystem.atoms = atoms;
+  subsystem.charge = charge;
+  subsystem.spin = spin;
+  subsystem.positions = positions;
+  subsystem.system = this->createSystem(std::make_shared<Sty::Geometry>(subsystemSymbols, positions), settings, subsystem.scratch);
+  return false;
+}
+
+template<Sty::Options::SCF_MODES ScfMode>
+double EmbeddingCalculator::calculateEnergy() {
+  // Subsystems of other settings, grids or elements are discarded, rebuilds of the same system are not
+  std::string parentFingerprint =
+      this->systemFingerprint() + "grid=" + std::to_string(_system->getSettings().grid.accuracy);
+  for (const auto& symbol : _geometry->getAtomSymbols()) {
+    parentFingerprint += "," + symbol;
+  }
+  if (parentFingerprint != _parentFingerprint) {
+    _active = Subsystem();
+    _environment = Subsystem();
+    _parentFingerprint = parentFingerprint;
+  }
+  const auto active = this->activeAtoms();
+  std::vector<unsigned int> environment;
+  for (unsigned int atom = 0; atom < _scinePositions->rows(); ++atom) {
+    if (!std::binary_search(active.begin(), active.end(), atom)) {
+      environment.push_back(atom);
+    }
+  }
+  // The active subsystem carries the charge and unpaired electrons of the whole system not in the environment
+  const auto& settings = _system->getSettings();
+  const int environmentCharge = _settings->getInt("embedding_environment_charge");
+  const int environmentSpin = _settings->getInt("embedding_environment_spin_multiplicity") - 1;
+  if (environmentSpin > settings.spin) {
+    throw std::runtime_error("The environment has more unpaired electrons than the whole system.");
+  }
+  if (environmentSpin > 0 && ScfMode == Sty::Options::SCF_MODES::RESTRICTED) {
+    throw std::runtime_error("An open-shell environment requires an unrestricted calculation ('spin_mode').");
+  }
+  this->updateSubsystem(_active, active, settings.charge - environmentCharge, settings.spin - environmentSpin);
+  const bool frozen = _settings->getString("embedding_mode") == "frozen_environment";
+  // A relaxed environment density is only a guess for the frozen one
+  const bool environmentUnchanged =
+      this->updateSubsystem(_environment, environment, environmentCharge, environmentSpin) &&
+      !(frozen && _environment.relaxed);
+  _calculationLog["embedding_environment"] = environmentUnchanged ? "reused" : "updated";
+
+  const auto start = std::chrono::steady_clock::now();
+  try {
+    if (!frozen) {
+      Sty::FreezeAndThawTask<ScfMode> fat({_active.system, _environment.system});
+      fat.settings.embedding = settings.embedding;
+      fat.settings.maxCycles = _settings->getInt("embedding_max_cycles");
+      fat.settings.convThresh = _settings->getDouble("embedding_convergence");
+      fat.run();
+    }
+    else if (!environmentUnchanged || !_environment.system->hasElectronicStructure<ScfMode>()) {
+      // The isolated environment density, frozen as long as the environment does not move
+      Sty::ScfTask<ScfMode> scf(_environment.system);
+      scf.run();
+    }
+    _environment.relaxed = !frozen;
+    /*
+     * The energy of the whole system is evaluated by a final FDE step, which is converged
+     * after a freeze-and-thaw run and only needs a few cycles.
+     */
+    Sty::FDETask<ScfMode> fde(_active.system, {_environment.system});
+    fde.settings.embedding = settings.embedding;
+    fde.settings.calculateEnvironmentEnergy = true;
+    fde.run();
+  }
+  catch (...) {
+    // The electronic structures may not belong to the stored positions anymore
+    _active = Subsystem();
+    _environment = Subsystem();
+    throw;
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  _calculationLog["embedding_time"] = std::to_string(elapsed.count());
+  return _active.system->getElectronicStructure<ScfMode>()->getEnergy(Sty::ENERGY_CONTRIBUTIONS::FDE_SUPERSYSTEM_ENERGY_DFT_DFT);
+}
+
+template<Sty::Options::SCF_MODES ScfMode>
+Eigen::MatrixXd EmbeddingCalculator::calculateGradients() {
+  // Each subsystem in the field of the other one
+  Sty::GradientTask<ScfMode> task({_active.system, _environment.system}, {});
+  task.settings.gradType = Sty::Options::GRADIENT_TYPES::ANALYTICAL;
+  task.settings.transInvar = false;
+  task.settings.embedding = _system->getSettings().embedding;
+  task.run();
+  Eigen::MatrixXd gradients = Eigen::MatrixXd::Zero(_scinePositions->rows(), 3);
+  for (const auto* subsystem : {&_active, &_environment}) {
+    const Eigen::MatrixXd subsystemGradients = subsystem->system->getGeometry()->getGradients();
+    for (unsigned int i = 0; i < subsystem->atoms.size(); ++i) {
+      gradients.row(subsystem->atoms[i]) = subsystemGradients.row(i);
+    }
+  }
+  return gradients;
+}
+
+template<Sty::Options::SCF_MODES ScfMode>
+void EmbeddingCalculator::calculateImpl() {
+  // The gradients always belong to the subsystems of the current system
+  this->runPlannedItems<ScfMode>([this]() { return this->calculateEnergy<ScfMode>(); },
+                                 [this](const std::shared_ptr<Sty::SystemController>& /*system*/) {
+                                   return this->calculateGradients<ScfMode>();
+                                 },
+                                 false);
+}
+
+bool EmbeddingCalculator::supportsMethodFamily(const std::string& methodFamily) const {
+  return methodFamily == "FDE";
+}
+
+} /* namespace Serenity */
+} /* namespace Scine */
@@ -0,0 +1,134 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef SERENITY_EMBEDDINGCALCULATOR_H_
+#define SERENITY_EMBEDDINGCALCULATOR_H_
+
+#include "Serenity/Calculators/CalculatorBase.h"
+/* Serenity Includes */
+#include <settings/Options.h>
+/* Scine Includes */
+#include <Core/Interfaces/Calculator.h>
+#include <Utils/CalculatorBasics.h>
+#include <Utils/Settings.h>
+#include <Utils/Technical/CloneInterface.h>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace Serenity {
+class Geometry;
+class SystemController;
+} // namespace Serenity
+namespace Sty = Serenity;
+
+namespace Scine {
+namespace Utils {}
+namespace Serenity {
+
+/**
+ * @brief An implementation of the Scine::Core::Calculator for frozen-density embedding (FDE) calculations.
+ *
+ * The structure is split into an active subsystem ('embedding_active_atoms') and its environment,
+ * both treated with the DFT method given in the settings and coupled through non-additive kinetic
+ * and exchange-correlation functionals ('emb_naddKinFunc', 'emb_naddXCFunc'). In the
+ * 'freeze_and_thaw' mode both densities are relaxed in the presence of each other, in the
+ * 'frozen_environment' mode the isolated environment density is used. Energies and gradients
+ * refer to the whole system; gradients are only available in the 'freeze_and_thaw' mode, the
+ * frozen environment density does not minimize the energy of the whole system.
+ *
+ * The environment carries 'embedding_environment_charge' and
+ * 'embedding_environment_spin_multiplicity', the active subsystem the rest of the charge and of
+ * the unpaired electrons of the whole system. No SCF is run for the whole system, it only holds
+ * the settings and answers the integral requests (overlap, one-electron matrix).
+ *
+ * The environment subsystem is kept across calculations while its atoms do not move, such that
+ * its density (the frozen one, or the guess for the freeze-and-thaw cycles) is reused. Both
+ * subsystems outlive rebuilds of the whole system that leave its settings, grid and elements
+ * unchanged (e.g. a new structure of the same elements).
+ */
+class EmbeddingCalculator : public Scine::Utils::CloneInterface<EmbeddingCalculator, CalculatorBase, Scine::Core::Calculator> {
+ public:
+  static constexpr const char* model = "FDE";
+  static constexpr const char* program = "Serenity";
+  /// @brief Default Constructor, adds the embedding settings.
+  EmbeddingCalculator();
+  /// @brief Default Destructor.
+  ~EmbeddingCalculator() = default;
+  /// @brief Copy Constructor.
+  EmbeddingCalculator(const EmbeddingCalculator& other) = default;
+  /**
+   * @brief Getter for the name of the underlying method.
+   * @returns Returns the name of the underlying method.
+   */
+  std::string name() const final;
+  /**
+   * @brief Getter for the possible properties, gradients only in the 'freeze_and_thaw' mode.
+   * @return Scine::Utils::PropertyList
+   */
+  Scine::Utils::PropertyList possibleProperties() const override;
+  /**
+   * @brief Check if the method family is supported by this calculator.
+   * @param methodFamily The method family as all caps string.
+   * @return true  If it is supported.
+   * @return false If it is not supported.
+   */
+  bool supportsMethodFamily(const std::string& methodFamily) const final;
+
+ protected:
+  void applyFixedSettings(Sty::Settings& settings) const final;
+  template<Sty::Options::SCF_MODES ScfMode>
+  void calculateImpl();
+  void calculateImplRestricted() final {
+    this->calculateImpl<Sty::RESTRICTED>();
+  }
+  void calculateImplUnrestricted() final {
+    this->calculateImpl<Sty::UNRESTRICTED>();
+  }
+  inline std::vector<std::string> availableSolvationModels() const final {
+    return {};
+  }
+  /// @brief The 'embedding_*' settings, the subsystems are kept when they change.
+  std::set<std::string> correlationKeys() const override;
+
+ private:
+  /// @brief A subsystem of the current structure.
+  struct Subsystem {
+    /// @brief The scratch directory of the system, declared first in order to outlive it.
+    std::shared_ptr<const ScratchManager::Directory> scratch;
+    std::shared_ptr<Sty::SystemController> system;
+    std::vector<unsigned int> atoms;
+    int charge = 0;
+    int spin = 0;
+    /// @brief The positions the current electronic structure belongs to, empty if none.
+    Eigen::MatrixXd positions;
+    /// @brief Whether the electronic structure was relaxed in the field of the other subsystem.
+    bool relaxed = false;
+  };
+  /// @brief The atom indices given by 'embedding_active_atoms' (e.g. '0,3-5').
+  std::vector<unsigned int> activeAtoms() const;
+  /**
+   * @brief Sets up or updates a subsystem for the current positions.
+   * @return bool Whether the subsystem still has the electronic structure of the current positions.
+   */
+  bool updateSubsystem(Subsystem& subsystem, const std::vector<unsigned int>& atoms, int charge, int spin);
+  /// @brief Runs the embedding and returns the energy of the whole system.
+  template<Sty::Options::SCF_MODES ScfMode>
+  double calculateEnergy();
+  /// @brief The gradients of the whole system, using the densities of the last embedding calculation.
+  template<Sty::Options::SCF_MODES ScfMode>
+  Eigen::MatrixXd calculateGradients();
+  Subsystem _active;
+  Subsystem _environment;
+  /// @brief The settings, grid and elements of the whole system the subsystems were set up for.
+  std::string _parentFingerprint;
+};
+
+} /* namespace Serenity */
+} /* namespace Scine */
+
+#endif /* SERENITY_EMBEDDINGCALCULATOR_H_ */
@@ -0,0 +1,387 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+/* Wrapper Includes */
+#include "Serenity/Calculators/GuessCache.h"
+/* Scine Includes */
+#include <Utils/Technical/UniqueIdentifier.h>
+/* External Includes */
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <vector>
+
+namespace Scine {
+namespace Serenity {
+
+namespace {
+constexpr char magic[8] = {'S', 'T', 'Y', 'G', 'U', 'E', 'S', '1'};
+// The resolution of the positions in the entry names (bohr)
+constexpr double positionResolution = 1.0e-4;
+// Bounds the matrix dimensions read from an entry, such that their product does not overflow
+constexpr std::uint64_t maxDimension = 0xFFFFFFFFull;
+
+/*
+ * 64 bit FNV-1a, stable across platforms and processes (unlike std::hash).
+ */
+std::uint64_t fnv1a(const std::string& data) {
+  std::uint64_t hash = 14695981039346656037ull;
+  for (const char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+std::string hex(std::uint64_t hash) {
+  std::ostringstream out;
+  out << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return out.str();
+}
+
+std::string entryFile(std::uint64_t hash) {
+  return hex(hash) + ".bin";
+}
+
+/*
+ * Sequential, bounds-checked reading of a mapped entry.
+ */
+class EntryReader {
+ public:
+  EntryReader(const char* data, std::size_t size) : _data(data), _size(size), _offset(0) {
+  }
+  bool read(void* target, std::size_t bytes) {
+    if (_offset + bytes > _size) {
+      return false;
+    }
+    std::memcpy(target, _data + _offset, bytes);
+    _offset += bytes;
+    return true;
+  }
+  bool readCount(std::uint64_t& value) {
+    return this->read(&value, sizeof(value));
+  }
+  /// Whether the given number of doubles is left, checked before allocating for them.
+  bool fits(std::uint64_t nDoubles) const {
+    return nDoubles <= (_size - _offset) / sizeof(double);
+  }
+
+ private:
+  const char* _data;
+  std::size_t _size;
+  std::size_t _offset;
+};
+
+bool readPositions(EntryReader& reader, Eigen::MatrixXd& positions) {
+  char header[sizeof(magic)];
+  std::uint64_t nAtoms = 0;
+  if (!reader.read(header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0 || !reader.readCount(nAtoms) ||
+      !reader.fits(3 * nAtoms)) {
+    return false;
+  }
+  Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> atomWise(nAtoms, 3);
+  if (!reader.read(atomWise.data(), nAtoms * 3 * sizeof(double))) {
+    return false;
+  }
+  positions = atomWise;
+  return true;
+}
+
+std::shared_ptr<const SerenityState::OrbitalData> readOrbitals(EntryReader& reader) {
+  std::uint64_t nSpins = 0;
+  if (!reader.readCount(nSpins) || nSpins < 1 || nSpins > 2) {
+    return nullptr;
+  }
+  std::vector<Eigen::MatrixXd> coefficients(nSpins);
+  std::vector<Eigen::VectorXd> eigenvalues(nSpins);
+  std::vector<unsigned int> nCore(nSpins);
+  std::vector<unsigned int> nOcc(nSpins);
+  for (unsigned int i = 0; i < nSpins; ++i) {
+    std::uint64_t rows = 0, cols = 0, nEigenvalues = 0, core = 0, occ = 0;
+    if (!reader.readCount(rows) || !reader.readCount(cols) || !reader.readCount(nEigenvalues) ||
+        !reader.readCount(core) || !reader.readCount(occ) || cols == 0 || rows > maxDimension || cols > maxDimension ||
+        !reader.fits(nEigenvalues) || !reader.fits(rows * cols + nEigenvalues)) {
+      return nullptr;
+    }
+    coefficients[i].resize(rows, cols);
+    eigenvalues[i].resize(nEigenvalues);
+    if (!reader.read(coefficients[i].data(), rows * cols * sizeof(double)) ||
+        !reader.read(eigenvalues[i].data(), nEigenvalues * sizeof(double))) {
+      return nullptr;
+    }
+    nCore[i] = static_cast<unsigned int>(core);
+    nOcc[i] = static_cast<unsigned int>(occ);
+  }
+  return std::make_shared<SerenityState::OrbitalData>(std::move(coefficients), std::move(eigenvalues),
+                                                      std::move(nCore), std::move(nOcc));
+}
+
+void writeCount(std::ofstream& out, std::uint64_t value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/*
+ * The index of a group: one record per entry, holding the hash of the entry name,
+ * the number of atoms and the positions (atom-wise x, y, z).
+ */
+struct IndexRecord {
+  std::uint64_t hash;
+  Eigen::MatrixXd positions;
+};
+
+std::vector<IndexRecord> readIndex(const std::string& file) {
+  std::ifstream in(file, std::ios::binary);
+  const std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  EntryReader reader(data.data(), data.size());
+  std::vector<IndexRecord> records;
+  IndexRecord record;
+  std::uint64_t nAtoms = 0;
+  // A record still being appended by another process ends the index
+  while (reader.readCount(record.hash) && reader.readCount(nAtoms) && nAtoms <= maxDimension && reader.fits(3 * nAtoms)) {
+    Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> atomWise(nAtoms, 3);
+    reader.read(atomWise.data(), nAtoms * 3 * sizeof(double));
+    record.positions = atomWise;
+    records.push_back(record);
+  }
+  return records;
+}
+
+void writeRecord(std::ofstream& out, const IndexRecord& record) {
+  writeCount(out, record.hash);
+  writeCount(out, record.positions.rows());
+  const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> atomWise = record.positions;
+  out.write(reinterpret_cast<const char*>(atomWise.data()), atomWise.size() * sizeof(double));
+}
+
+std::uintmax_t readTotal(const std::string& file, bool& known) {
+  std::ifstream in(file, std::ios::binary);
+  std::uint64_t total = 0;
+  known = static_cast<bool>(in.read(reinterpret_cast<char*>(&total), sizeof(total)));
+  return total;
+}
+
+void writeTotal(const std::string& file, std::uintmax_t total) {
+  std::ofstream out(file, std::ios::binary | std::ios::trunc);
+  writeCount(out, total);
+}
+} // namespace
+
+GuessCache::GuessCache(std::string directory, double sizeLimit) : _directory(std::move(directory)), _sizeLimit(sizeLimit) {
+  if (!_directory.empty() && _directory.back() != '/') {
+    _directory += "/";
+  }
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(_directory, ec);
+}
+
+std::string GuessCache::groupDirectory(const std::string& key) const {
+  return _directory + hex(fnv1a(key)) + "/";
+}
+
+std::uint64_t GuessCache::entryHash(const std::string& key, const Eigen::MatrixXd& positions) const {
+  std::ostringstream canonical;
+  canonical << key;
+  for (unsigned int i = 0; i < positions.rows(); ++i) {
+    for (unsigned int j = 0; j < positions.cols(); ++j) {
+      const auto rounded = static_cast<long long>(std::llround(positions(i, j) / positionResolution));
+      canonical << "|" << rounded;
+    }
+  }
+  return fnv1a(canonical.str());
+}
+
+std::shared_ptr<const SerenityState::OrbitalData> GuessCache::load(const std::string& key, const Eigen::MatrixXd& positions,
+                                                                   double tolerance, bool& exact) const {
+  namespace bfs = boost::filesystem;
+  namespace bip = boost::interprocess;
+  const std::string group = this->groupDirectory(key);
+  const std::uint64_t hash = this->entryHash(key, positions);
+  // Candidates from the index of the group: the exact entry first, then by distance
+  std::vector<std::pair<double, std::uint64_t>> candidates;
+  for (const auto& record : readIndex(group + "index")) {
+    if (record.positions.rows() != positions.rows()) {
+      continue;
+    }
+    const double distance = (record.hash == hash) ? -1.0 : (record.positions - positions).rowwise().norm().maxCoeff();
+    if (distance < tolerance) {
+      candidates.emplace_back(distance, record.hash);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+  for (const auto& candidate : candidates) {
+    const std::string file = group + entryFile(candidate.second);
+    try {
+      bip::file_mapping mapping(file.c_str(), bip::read_only);
+      bip::mapped_region region(mapping, bip::read_only);
+      EntryReader reader(static_cast<const char*>(region.get_address()), region.get_size());
+      Eigen::MatrixXd cached;
+      if (!readPositions(reader, cached) || cached.rows() != positions.rows()) {
+        continue;
+      }
+      auto orbitals = readOrbitals(reader);
+      if (orbitals) {
+        exact = (candidate.second == hash);
+        // Mark as recently used
+        boost::system::error_code ec;
+        bfs::last_write_time(file, std::time(nullptr), ec);
+        return orbitals;
+      }
+    }
+    catch (const bip::interprocess_exception&) {
+      // Concurrently evicted entry
+    }
+  }
+  return nullptr;
+}
+
+void GuessCache::store(const std::string& key, const Eigen::MatrixXd& positions,
+                       const SerenityState::OrbitalData& orbitals) const {
+  namespace bfs = boost::filesystem;
+  const std::string group = this->groupDirectory(key);
+  boost::system::error_code ec;
+  bfs::create_directories(group, ec);
+  Scine::Utils::UniqueIdentifier uid;
+  const std::string temporary = group + uid.getStringRepresentation() + ".tmp";
+  {
+    std::ofstream out(temporary, std::ios::binary);
+    out.write(magic, sizeof(magic));
+    writeCount(out, positions.rows());
+    const Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor> atomWise = positions;
+    out.write(reinterpret_cast<const char*>(atomWise.data()), atomWise.size() * sizeof(double));
+    writeCount(out, orbitals.coefficients.size());
+    for (unsigned int i = 0; i < orbitals.coefficients.size(); ++i) {
+      const auto& coefficients = orbitals.coefficients[i];
+      const auto& eigenvalues = orbitals.eigenvalues[i];
+      writeCount(out, coefficients.rows());
+      writeCount(out, coefficients.cols());
+      writeCount(out, eigenvalues.size());
+      writeCount(out, orbitals.nCoreOrbitals[i]);
+      writeCount(out, orbitals.nOccupiedOrbitals[i]);
+      out.write(reinterpret_cast<const char*>(coefficients.data()), coefficients.size() * sizeof(double));
+      out.write(reinterpret_cast<const char*>(eigenvalues.data()), eigenvalues.size() * sizeof(double));
+    }
+    out.close();
+    if (!out) {
+      bfs::remove(temporary, ec);
+      return;
+    }
+  }
+  const std::uintmax_t size = bfs::file_size(temporary, ec);
+  const std::uint64_t hash = this->entryHash(key, positions);
+  const std::string file = group + entryFile(hash);
+  const std::string lockFile = _directory + ".lock";
+  // file_lock requires an existing file
+  std::ofstream(lockFile, std::ios::app).close();
+  try {
+    namespace bip = boost::interprocess;
+    bip::file_lock lock(lockFile.c_str());
+    bip::scoped_lock<bip::file_lock> guard(lock);
+    // Atomically replaces an older entry of the same positions, which is already indexed
+    const bool replaces = bfs::exists(file, ec);
+    const std::uintmax_t replaced = replaces ? bfs::file_size(file, ec) : 0;
+    bfs::rename(temporary, file, ec);
+    if (ec) {
+      bfs::remove(temporary, ec);
+      return;
+    }
+    if (!replaces) {
+      std::ofstream index(group + "index", std::ios::binary | std::ios::app);
+      writeRecord(index, {hash, positions});
+    }
+    // The total size is kept in a file of its own, the entries are only listed if it is exceeded
+    bool known = false;
+    std::uintmax_t total = readTotal(_directory + "size", known) + size;
+    total = (total > replaced) ? total - replaced : 0;
+    const auto limit = static_cast<std::uintmax_t>(_sizeLimit * 1024.0 * 1024.0);
+    if (!known || total > limit) {
+      total = this->evict();
+    }
+    writeTotal(_directory + "size", total);
+  }
+  catch (const boost::interprocess::interprocess_exception&) {
+    // Locking is not supported on this file system, the entry is stored without a size limit
+    const bool replaces = bfs::exists(file, ec);
+    bfs::rename(temporary, file, ec);
+    if (ec) {
+      bfs::remove(temporary, ec);
+    }
+    else if (!replaces) {
+      std::ofstream index(group + "index", std::ios::binary | std::ios::app);
+      writeRecord(index, {hash, positions});
+    }
+  }
+}
+
+std::uintmax_t GuessCache::evict() const {
+  namespace bfs = boost::filesystem;
+  std::vector<std::pair<std::time_t, std::pair<std::uintmax_t, bfs::path>>> entries;
+  std::uintmax_t total = 0;
+  boost::system::error_code ec;
+  const std::time_t now = std::time(nullptr);
+  for (bfs::recursive_directory_iterator it(_directory, ec), end; !ec && it != end; it.increment(ec)) {
+    const auto extension = it->path().extension();
+    const auto time = bfs::last_write_time(it->path(), ec);
+    if (extension == ".tmp" && !ec && now - time > 3600) {
+      // Left behind by a process that died while writing
+      bfs::remove(it->path(), ec);
+      continue;
+    }
+    if (extension != ".bin") {
+      continue;
+    }
+    const auto size = bfs::file_size(it->path(), ec);
+    if (!ec) {
+      entries.push_back({time, {size, it->path()}});
+      total += size;
+    }
+  }
+  const auto limit = static_cast<std::uintmax_t>(_sizeLimit * 1024.0 * 1024.0);
+  if (total <= limit) {
+    return total;
+  }
+  // Least recently used first
+  std::sort(entries.begin(), entries.end());
+  std::set<bfs::path> groups;
+  for (const auto& entry : entries) {
+    if (total <= limit) {
+      break;
+    }
+    if (bfs::remove(entry.second.second, ec)) {
+      total -= entry.second.first;
+      groups.insert(entry.second.second.parent_path());
+    }
+  }
+  // The indices only list the remaining entries
+  for (const auto& group : groups) {
+    const std::string index = (group / "index").string();
+    const std::string temporary = index + ".tmp";
+    {
+      std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+      for (const auto& record : readIndex(index)) {
+        if (bfs::exists(group / entryFile(record.hash), ec)) {
+          writeRecord(out, record);
+        }
+      }
+    }
+    bfs::rename(temporary, index, ec);
+  }
+  return total;
+}
+
+} /* namespace Serenity */
+} /* namespace Scine */
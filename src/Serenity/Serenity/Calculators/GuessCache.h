@@ -0,0 +1,77 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef SERENITY_GUESSCACHE_H_
+#define SERENITY_GUESSCACHE_H_
+
+/* Wrapper Includes */
+#include "Serenity/Calculators/SerenityState.h"
+/* External Includes */
+#include <Eigen/Dense>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Scine {
+namespace Serenity {
+
+/**
+ * @brief An on-disk cache of converged orbitals, shared by all processes using the same directory.
+ *
+ * Entries are grouped by a key describing everything but the positions (elements, charge,
+ * multiplicity, basis, method, ...). Within such a group, each entry is stored in a file named
+ * by the hash of the key and the rounded positions, and listed with its positions in the
+ * 'index' file of the group. Lookups read the index and map only the chosen entry into memory.
+ * Files are written to a temporary name and renamed afterwards, such that readers never see
+ * partially written entries. Writers update the indices and the total size of all entries
+ * (the 'size' file) under a lock file; only once the size limit is exceeded are all entries
+ * listed and the least recently used ones removed.
+ *
+ * File layout (all fields 8 bytes wide):
+ *   magic, number of atoms, number of spins, positions (atom-wise x, y, z), and per spin:
+ *   rows, columns, number of eigenvalues, core orbitals, occupied orbitals,
+ *   coefficients (column-major), eigenvalues.
+ * Index layout, per entry: hash of the file name, number of atoms, positions.
+ */
+class GuessCache {
+ public:
+  /**
+   * @brief Construct a new GuessCache.
+   * @param directory The cache directory, created if missing.
+   * @param sizeLimit The maximal size of all entries in MB.
+   */
+  GuessCache(std::string directory, double sizeLimit);
+  /**
+   * @brief Looks up the orbitals of the given or of nearby positions.
+   * @param key       The key describing the structure except for the positions.
+   * @param positions The positions.
+   * @param tolerance The largest displacement of any atom (bohr) for a nearby entry to be used.
+   * @param exact     Returns whether the entry matches the rounded positions exactly.
+   * @return std::shared_ptr<const SerenityState::OrbitalData> The orbitals, nullptr if there are none.
+   */
+  std::shared_ptr<const SerenityState::OrbitalData> load(const std::string& key, const Eigen::MatrixXd& positions,
+                                                         double tolerance, bool& exact) const;
+  /**
+   * @brief Stores the orbitals of the given positions, evicting old entries if required.
+   * @param key       The key describing the structure except for the positions.
+   * @param positions The positions.
+   * @param orbitals  The orbitals.
+   */
+  void store(const std::string& key, const Eigen::MatrixXd& positions, const SerenityState::OrbitalData& orbitals) const;
+
+ private:
+  std::string groupDirectory(const std::string& key) const;
+  std::uint64_t entryHash(const std::string& key, const Eigen::MatrixXd& positions) const;
+  /// @brief Removes the least recently used entries above the size limit, returns the size of the others.
+  std::uintmax_t evict() const;
+  std::string _directory;
+  double _sizeLimit;
+};
+
+} /* namespace Serenity */
+} /* namespace Scine */
+
+#endif /* SERENITY_GUESSCACHE_H_ */
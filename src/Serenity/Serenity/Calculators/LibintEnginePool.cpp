@@ -0,0 +1,71 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+/* Wrapper Includes */
+#include "Serenity/Calculators/LibintEnginePool.h"
+/* External Includes */
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
+
+namespace Scine {
+namespace Serenity {
+
+LibintEnginePool& LibintEnginePool::getInstance() {
+  // Never destroyed, calculators (and their leases) may outlive static objects
+  static auto* pool = new LibintEnginePool();
+  return *pool;
+}
+
+LibintEnginePool::Lease LibintEnginePool::acquire(Sty::LIBINT_OPERATOR op, unsigned int derivative, unsigned int nCenters) {
+#ifdef _OPENMP
+  const auto nThreads = static_cast<unsigned int>(omp_get_max_threads());
+#else
+  const unsigned int nThreads = 1;
+#endif
+  const Key key(op, derivative, nCenters);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& entry = _entries[key];
+    auto& libint = Sty::Libint::getInstance();
+    if (entry.nLeases == 0) {
+      libint.keepEngines(op, derivative, nCenters);
+      entry.nThreads = nThreads;
+    }
+    else if (nThreads > entry.nThreads) {
+      // Drop the engines built for fewer threads, the existing leases stay valid
+      libint.freeEngines(op, derivative, nCenters);
+      libint.keepEngines(op, derivative, nCenters);
+      entry.nThreads = nThreads;
+    }
+    ++entry.nLeases;
+  }
+  // Only the deleter matters
+  return Lease(new Key(key), [](const Key* leased) {
+    LibintEnginePool::getInstance().release(*leased);
+    delete leased;
+  });
+}
+
+unsigned int LibintEnginePool::nLeases(Sty::LIBINT_OPERATOR op, unsigned int derivative, unsigned int nCenters) const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto it = _entries.find(Key(op, derivative, nCenters));
+  return it == _entries.end() ? 0 : it->second.nLeases;
+}
+
+void LibintEnginePool::release(const Key& key) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto it = _entries.find(key);
+  if (it == _entries.end() || it->second.nLeases == 0) {
+    return;
+  }
+  if (--it->second.nLeases == 0) {
+    Sty::Libint::getInstance().freeEngines(std::get<0>(key), std::get<1>(key), std::get<2>(key));
+  }
+}
+
+} /* namespace Serenity */
+} /* namespace Scine */
@@ -0,0 +1,68 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef SERENITY_LIBINTENGINEPOOL_H_
+#define SERENITY_LIBINTENGINEPOOL_H_
+
+/* Serenity Includes */
+#include <integrals/wrappers/Libint.h>
+/* External Includes */
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+// Namespace alias to avoid abiguity
+namespace Sty = Serenity;
+
+namespace Scine {
+namespace Serenity {
+
+/**
+ * @brief Keeps Serenity's Libint engines alive for as long as any calculator needs them.
+ *
+ * Serenity frees its integral engines after each use unless they are explicitly kept.
+ * Calculators lease the engines they are about to use; the first lease of an engine type
+ * keeps it, the last one gone frees it again. Short-lived calculators and clones hence do
+ * not churn engine allocations, and engine types nobody uses are not kept.
+ *
+ * The engines are sized to the OpenMP threads available when they are first kept. A lease
+ * taken with more threads available re-keeps the engine type, such that it is recreated
+ * for the larger thread count.
+ */
+class LibintEnginePool {
+ public:
+  /// @brief A lease, the engine type is kept as long as any copy of it exists.
+  using Lease = std::shared_ptr<const void>;
+  /// @brief Getter for the pool of this process.
+  static LibintEnginePool& getInstance();
+  /**
+   * @brief Keeps an engine type.
+   * @param op         The operator.
+   * @param derivative The derivative level.
+   * @param nCenters   The number of centers.
+   * @return Lease The lease.
+   */
+  Lease acquire(Sty::LIBINT_OPERATOR op, unsigned int derivative, unsigned int nCenters);
+  /// @brief The number of leases alive for an engine type.
+  unsigned int nLeases(Sty::LIBINT_OPERATOR op, unsigned int derivative, unsigned int nCenters) const;
+
+ private:
+  LibintEnginePool() = default;
+  using Key = std::tuple<Sty::LIBINT_OPERATOR, unsigned int, unsigned int>;
+  struct Entry {
+    unsigned int nLeases = 0;
+    unsigned int nThreads = 0;
+  };
+  void release(const Key& key);
+  mutable std::mutex _mutex;
+  std::map<Key, Entry> _entries;
+};
+
+} /* namespace Serenity */
+} /* namespace Scine */
+
+#endif /* SERENITY_LIBINTENGINEPOOL_H_ */
@@ -0,0 +1,154 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#include "Serenity/Calculators/MP2Calculator.h"
+#include "Serenity/Calculators/ScineSettings.h"
+/* Serenity Includes */
+#include <data/ElectronicStructure.h>
+#include <energies/EnergyContributions.h>
+#include <geometry/Geometry.h>
+#include <settings/Settings.h>
+#include <system/SystemController.h>
+#include <tasks/MP2Task.h>
+#include <tasks/ScfTask.h>
+/* Scine Includes */
+#include <Utils/Geometry.h>
+#include <Utils/Typenames.h>
+#include <Utils/UniversalSettings/SettingsNames.h>
+#include <algorithm>
+#include <chrono>
+
+namespace Sty = Serenity;
+
+namespace Scine {
+namespace Serenity {
+
+MP2Calculator::MP2Calculator() {
+  this->_settings = std::make_unique<ScineSettings>(std::vector<ScineSettings::Group>{
+      ScineSettings::Group::NumericalGradients, ScineSettings::Group::LocalCorrelation, ScineSettings::Group::MP2});
+}
+
+std::string MP2Calculator::name() const {
+  return "SerenityMP2Calculator";
+}
+
+Scine::Utils::PropertyList MP2Calculator::possibleProperties() const {
+  return Scine::Utils::Property::Energy | Scine::Utils::Property::Gradients | Scine::Utils::Property::AtomicCharges |
+         Scine::Utils::Property::OverlapMatrix | Scine::Utils::Property::AOtoAtomMapping |
+         Scine::Utils::Property::OneElectronMatrix;
+}
+
+void MP2Calculator::applyFixedSettings(Sty::Settings& settings) const {
+  settings.method = Sty::Options::ELECTRONIC_STRUCTURE_THEORIES::HF;
+}
+
+MP2Calculator::Variant MP2Calculator::variant() const {
+  auto method = _settings->getString(Scine::Utils::SettingsNames::method);
+  std::transform(method.begin(), method.end(), method.begin(), ::tolower);
+  Variant variant{Sty::Options::MP2_TYPES::DF, _settings->getDouble("mp2_same_spin_scaling"),
+                  _settings->getDouble("mp2_opposite_spin_scaling")};
+  // Grimme's SCS-MP2 and the SOS-MP2 of Jung et al.
+  const std::string prefix = method.substr(0, 4);
+  if (prefix == "scs-") {
+    variant.sameSpinScaling = 1.0 / 3.0;
+    variant.oppositeSpinScaling = 1.2;
+    method = method.substr(4);
+  }
+  else if (prefix == "sos-") {
+    variant.sameSpinScaling = 0.0;
+    variant.oppositeSpinScaling = 1.3;
+    method = method.substr(4);
+  }
+  if (method == "mp2" || method == "ri-mp2") {
+    variant.type = Sty::Options::MP2_TYPES::DF;
+  }
+  else if (method == "dlpno-mp2" || method == "local-mp2") {
+    variant.type = Sty::Options::MP2_TYPES::LOCAL;
+  }
+  else {
+    throw std::runtime_error("Unknown MP2 method '" + _settings->getString(Scine::Utils::SettingsNames::method) +
+                             "', expected '(scs-|sos-)ri-mp2' or '(scs-|sos-)dlpno-mp2'.");
+  }
+  return variant;
+}
+
+std::set<std::string> MP2Calculator::correlationKeys() const {
+  auto keys = localCorrelationKeys();
+  keys.insert(Scine::Utils::SettingsNames::method);
+  keys.insert("mp2_same_spin_scaling");
+  keys.insert("mp2_opposite_spin_scaling");
+  return keys;
+}
+
+std::set<std::string> MP2Calculator::gradientKeys() const {
+  return {"numerical_gradient_step"};
+}
+
+template<Sty::Options::SCF_MODES ScfMode>
+double MP2Calculator::correlationEnergy(const std::shared_ptr<Sty::SystemController>& system, const Variant& variant) const {
+  Sty::MP2Task<ScfMode> mp2(system);
+  mp2.settings.mp2Type = variant.type;
+  mp2.settings.ss = variant.sameSpinScaling;
+  mp2.settings.os = variant.oppositeSpinScaling;
+  this->applyLocalCorrelationSettings(mp2.settings.lcSettings);
+  mp2.run();
+  return system->getElectronicStructure<ScfMode>()->getEnergy(Sty::ENERGY_CONTRIBUTIONS::KS_DFT_PERTURBATIVE_CORRELATION);
+}
+
+template<Sty::Options::SCF_MODES ScfMode>
+double MP2Calculator::calculateEnergy(const Variant& variant) {
+  using Clock = std::chrono::steady_clock;
+  // DLPNO-MP2 runs on IBO-localized orbitals, RI-MP2 on the canonical ones
+  const double hf = this->prepareReference<ScfMode>(variant.type == Sty::Options::MP2_TYPES::LOCAL, "mp2");
+  const auto start = Clock::now();
+  const double correlation = this->correlationEnergy<ScfMode>(_system, variant);
+  _calculationLog["correlation_time"] = std::to_string(std::chrono::duration<double>(Clock::now() - start).count());
+  return hf + correlation;
+}
+
+template<Sty::Options::SCF_MODES ScfMode>
+Eigen::MatrixXd MP2Calculator::calculateGradients(const Variant& variant) const {
+  const double step = _settings->getDouble("numerical_gradient_step");
+  const auto positions = this->centralDisplacements(step);
+  const unsigned int nCoordinates = positions.size() / 2;
+  auto energies = this->runDisplacements(positions, false, [&](unsigned int task) -> Eigen::VectorXd {
+    // Starts from the orbitals of the reference geometry
+    std::shared_ptr<const ScratchManager::Directory> scratch;
+    auto system = this->displacedSystem<ScfMode>(positions[task], scratch);
+    Sty::ScfTask<ScfMode> scf(system);
+    scf.run();
+    const double hf = system->getElectronicStructure<ScfMode>()->getEnergy(Sty::ENERGY_CONTRIBUTIONS::HF_ENERGY);
+    if (variant.type == Sty::Options::MP2_TYPES::LOCAL) {
+      localizeOrbitals(system);
+    }
+    return Eigen::VectorXd::Constant(1, hf + this->correlationEnergy<ScfMode>(system, variant));
+  });
+  Eigen::MatrixXd gradients(nCoordinates / 3, 3);
+  for (unsigned int i = 0; i < nCoordinates; ++i) {
+    gradients(i / 3, i % 3) = (energies(2 * i, 0) - energies(2 * i + 1, 0)) / (2.0 * step);
+  }
+  return gradients;
+}
+
+template<Sty::Options::SCF_MODES ScfMode>
+void MP2Calculator::calculateImpl() {
+  const auto variant = this->variant();
+  if (ScfMode == Sty::Options::SCF_MODES::UNRESTRICTED && variant.type == Sty::Options::MP2_TYPES::LOCAL)
+    throw std::runtime_error("Unrestricted DLPNO-MP2 calculations are not yet supported in Serenity.");
+  // The numerical gradients always belong to the current system
+  this->runPlannedItems<ScfMode>([this, &variant]() { return this->calculateEnergy<ScfMode>(variant); },
+                                 [this, &variant](const std::shared_ptr<Sty::SystemController>& /*system*/) {
+                                   return this->calculateGradients<ScfMode>(variant);
+                                 },
+                                 false);
+}
+
+bool MP2Calculator::supportsMethodFamily(const std::string& methodFamily) const {
+  return methodFamily == "MP2";
+}
+
+} /* namespace Serenity */
+} /* namespace Scine */
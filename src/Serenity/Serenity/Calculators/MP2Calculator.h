@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef SERENITY_MP2CALCULATOR_H_
+#define SERENITY_MP2CALCULATOR_H_
+
+#include "Serenity/Calculators/CalculatorBase.h"
+/* Serenity Includes */
+#include <settings/Options.h>
+/* Scine Includes */
+#include <Core/Interfaces/Calculator.h>
+#include <Utils/CalculatorBasics.h>
+#include <Utils/Settings.h>
+#include <Utils/Technical/CloneInterface.h>
+#include <memory>
+#include <set>
+#include <string>
+
+namespace Serenity {
+class Geometry;
+class SystemController;
+} // namespace Serenity
+namespace Sty = Serenity;
+
+namespace Scine {
+namespace Utils {}
+namespace Serenity {
+
+/**
+ * @brief An implementation of the Scine::Core::Calculator for single system MP2 calculations.
+ *
+ * The 'method' selects canonical RI-MP2 ('ri-mp2' or 'mp2', using 'basis_auxCLabel') or
+ * DLPNO-MP2 ('dlpno-mp2' or 'local-mp2', using the DLPNO thresholds). A prefix 'scs-' or
+ * 'sos-' applies the usual spin-component scaling, otherwise 'mp2_same_spin_scaling' and
+ * 'mp2_opposite_spin_scaling' are used.
+ */
+class MP2Calculator : public Scine::Utils::CloneInterface<MP2Calculator, CalculatorBase, Scine::Core::Calculator> {
+ public:
+  static constexpr const char* model = "MP2";
+  static constexpr const char* program = "Serenity";
+  /// @brief Default Constructor, adds the settings of MP2, local correlation and numerical gradients.
+  MP2Calculator();
+  /// @brief Default Destructor.
+  ~MP2Calculator() = default;
+  /// @brief Copy Constructor.
+  MP2Calculator(const MP2Calculator& other) = default;
+  /**
+   * @brief Getter for the name of the underlying method.
+   * @returns Returns the name of the underlying method.
+   */
+  std::string name() const final;
+  /**
+   * @brief
+   * @return Scine::Utils::PropertyList
+   */
+  Scine::Utils::PropertyList possibleProperties() const override;
+  /**
+   * @brief Check if the method family is supported by this calculator.
+   * @param methodFamily The method family as all caps string.
+   * @return true  If it is supported.
+   * @return false If it is not supported.
+   */
+  bool supportsMethodFamily(const std::string& methodFamily) const final;
+
+ protected:
+  /// @brief The MP2 variant chosen by the settings.
+  struct Variant {
+    Sty::Options::MP2_TYPES type;
+    double sameSpinScaling;
+    double oppositeSpinScaling;
+  };
+  void applyFixedSettings(Sty::Settings& settings) const final;
+  template<Sty::Options::SCF_MODES ScfMode>
+  void calculateImpl();
+  /// @brief Parses the 'method' setting and the spin-component scaling.
+  Variant variant() const;
+  /**
+   * @brief Runs the MP2 calculation on the orbitals present in a system.
+   * @return double The (scaled) correlation energy.
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  double correlationEnergy(const std::shared_ptr<Sty::SystemController>& system, const Variant& variant) const;
+  /**
+   * @brief Calculates the MP2 energy of the current system.
+   *
+   * As long as the structure and the system stay the same, the HF reference (and the localized
+   * orbitals of DLPNO-MP2) is reused and only the MP2 calculation is rerun for other MP2 settings
+   * (see prepareReference()).
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  double calculateEnergy(const Variant& variant);
+  /**
+   * @brief Calculates the gradients by central finite differences of MP2 energies.
+   *
+   * Serenity offers no analytical MP2 gradients; the displaced calculations are run as in the
+   * CC calculator ('numerical_gradient_step', 'displacement_workers').
+   */
+  template<Sty::Options::SCF_MODES ScfMode>
+  Eigen::MatrixXd calculateGradients(const Variant& variant) const;
+  void calculateImplRestricted() final {
+    this->calculateImpl<Sty::RESTRICTED>();
+  }
+  void calculateImplUnrestricted() final {
+    this->calculateImpl<Sty::UNRESTRICTED>();
+  }
+
+ private:
+  inline std::vector<std::string> availableSolvationModels() const final {
+    return {};
+  }
+  /// @brief The MP2 variant ('method'), its scaling and the DLPNO thresholds only affect the correlation step.
+  std::set<std::string> correlationKeys() const override;
+  /// @brief The displacement of the numerical gradients only affects those.
+  std::set<std::string> gradientKeys() const override;
+};
+
+} /* namespace Serenity */
+} /* namespace Scine */
+
+#endif /* SERENITY_MP2CALCULATOR_H_ */
@@ -0,0 +1,54 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+/* Wrapper Includes */
+#include "Serenity/Calculators/OutputContext.h"
+/* External Includes */
+#include <iostream>
+
+namespace Scine {
+namespace Serenity {
+
+std::recursive_mutex& OutputContext::mutex() {
+  static std::recursive_mutex mutex;
+  return mutex;
+}
+
+OutputContext::OutputContext(bool showOutput)
+  : _lock(mutex()), _printLevel(Sty::GLOBAL_PRINT_LEVEL), _ioOptions(Sty::iOOptions), _coutBuffer(nullptr) {
+  if (!showOutput) {
+    Sty::GLOBAL_PRINT_LEVEL = Sty::Options::GLOBAL_PRINT_LEVELS::MINIMUM;
+    Sty::iOOptions.printFinalOrbitalEnergies = false;
+    Sty::iOOptions.printGeometry = false;
+    Sty::iOOptions.printSCFCycleInfo = false;
+    Sty::iOOptions.printSCFResults = false;
+    Sty::iOOptions.printDebugInfos = false;
+    Sty::iOOptions.printGridInfo = false;
+    Sty::iOOptions.gridAccuracyCheck = false;
+    Sty::iOOptions.timingsPrintLevel = 0;
+  }
+}
+
+OutputContext::~OutputContext() {
+  if (_coutBuffer) {
+    std::cout.rdbuf(_coutBuffer);
+  }
+  Sty::GLOBAL_PRINT_LEVEL = _printLevel;
+  Sty::iOOptions = _ioOptions;
+}
+
+void OutputContext::redirect(const std::string& file) {
+  std::cout.flush();
+  _redirect.close();
+  _redirect.open(file);
+  auto previous = std::cout.rdbuf(_redirect.rdbuf());
+  if (!_coutBuffer) {
+    _coutBuffer = previous;
+  }
+}
+
+} /* namespace Serenity */
+} /* namespace Scine */
@@ -0,0 +1,67 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef SERENITY_OUTPUTCONTEXT_H_
+#define SERENITY_OUTPUTCONTEXT_H_
+
+/* Serenity Includes */
+#include <io/FormattedOutputStream.h>
+#include <settings/Options.h>
+/* External Includes */
+#include <fstream>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+
+// Namespace alias to avoid abiguity
+namespace Sty = Serenity;
+
+namespace Scine {
+namespace Serenity {
+
+/**
+ * @brief The output settings of one calculator for the duration of a Serenity call.
+ *
+ * Serenity controls its verbosity through process globals (GLOBAL_PRINT_LEVEL, iOOptions)
+ * and prints to std::cout. A context applies the verbosity of its calculator, optionally
+ * redirects std::cout into a file, and restores everything upon destruction.
+ *
+ * Contexts hold a process-wide recursive lock for their lifetime: calculators used from
+ * several threads (the GIL is released during calculations) run their Serenity calls one
+ * after the other instead of racing on the globals. Serenity reads these globals throughout
+ * a calculation, hence the lock is held for the whole call and calculations are serialized,
+ * not just the swaps of the globals. Nested contexts in the same thread are allowed.
+ */
+class OutputContext {
+ public:
+  /**
+   * @brief Constructor, waits for contexts of other threads to end.
+   * @param showOutput If false, Serenity's output is reduced to the minimum.
+   */
+  explicit OutputContext(bool showOutput);
+  /// @brief Destructor, restores the output settings and std::cout found upon construction.
+  ~OutputContext();
+  OutputContext(const OutputContext& other) = delete;
+  OutputContext& operator=(const OutputContext& other) = delete;
+  /**
+   * @brief Redirects std::cout into a file until the context ends.
+   * @param file The file, overwritten.
+   */
+  void redirect(const std::string& file);
+
+ private:
+  static std::recursive_mutex& mutex();
+  std::unique_lock<std::recursive_mutex> _lock;
+  Sty::Options::GLOBAL_PRINT_LEVELS _printLevel;
+  Sty::IOOptions _ioOptions;
+  std::ofstream _redirect;
+  std::streambuf* _coutBuffer;
+};
+
+} /* namespace Serenity */
+} /* namespace Scine */
+
+#endif /* SERENITY_OUTPUTCONTEXT_H_ */
@@ -0,0 +1,149 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+/* Wrapper Includes */
+#include "Serenity/Calculators/PropertyPlanner.h"
+
+namespace Scine {
+namespace Serenity {
+
+namespace {
+using Item = PropertyPlanner::Item;
+const std::vector<Item> allItems = {Item::Scf,            Item::Gradients,  Item::AtomicCharges, Item::IntegralExports,
+                                    Item::DensityExports, Item::BondOrders, Item::Hessian,       Item::Thermochemistry};
+
+void addWithDependencies(Item item, std::set<Item>& items) {
+  if (!items.insert(item).second) {
+    return;
+  }
+  for (const auto dependency : PropertyPlanner::dependencies(item)) {
+    addWithDependencies(dependency, items);
+  }
+}
+
+bool dependsOn(Item item, Item dependency) {
+  for (const auto direct : PropertyPlanner::dependencies(item)) {
+    if (direct == dependency || dependsOn(direct, dependency)) {
+      return true;
+    }
+  }
+  return false;
+}
+} // namespace
+
+std::vector<PropertyPlanner::Item> PropertyPlanner::plan(const Utils::PropertyList& required) {
+  std::set<Item> items;
+  for (const auto item : allItems) {
+    for (const auto property : outputs(item)) {
+      if (required.containsSubSet(property)) {
+        addWithDependencies(item, items);
+        break;
+      }
+    }
+  }
+  // The thermochemistry is cheap once the Hessian is known and has always come with it
+  if (items.count(Item::Hessian) > 0) {
+    items.insert(Item::Thermochemistry);
+  }
+  // The enumeration order is a valid execution order
+  return std::vector<Item>(items.begin(), items.end());
+}
+
+std::vector<PropertyPlanner::Item> PropertyPlanner::dependencies(Item item) {
+  switch (item) {
+    case Item::Scf:
+    case Item::IntegralExports:
+      return {};
+    case Item::Gradients:
+    case Item::Hessian:
+    case Item::AtomicCharges:
+    case Item::DensityExports:
+      return {Item::Scf};
+    case Item::BondOrders:
+      return {Item::IntegralExports, Item::DensityExports};
+    case Item::Thermochemistry:
+      return {Item::Scf, Item::Hessian};
+  }
+  return {};
+}
+
+std::vector<Utils::Property> PropertyPlanner::outputs(Item item) {
+  switch (item) {
+    case Item::Scf:
+      return {Utils::Property::Energy};
+    case Item::Gradients:
+      return {Utils::Property::Gradients};
+    case Item::Hessian:
+      return {Utils::Property::Hessian};
+    case Item::AtomicCharges:
+      return {Utils::Property::AtomicCharges};
+    case Item::IntegralExports:
+      return {Utils::Property::AOtoAtomMapping, Utils::Property::OverlapMatrix, Utils::Property::OneElectronMatrix};
+    case Item::DensityExports:
+      return {Utils::Property::DensityMatrix, Utils::Property::ElectronicOccupation};
+    case Item::BondOrders:
+      return {Utils::Property::BondOrderMatrix};
+    case Item::Thermochemistry:
+      return {Utils::Property::Thermochemistry};
+  }
+  return {};
+}
+
+std::string PropertyPlanner::name(Item item) {
+  switch (item) {
+    case Item::Scf:
+      return "scf";
+    case Item::Gradients:
+      return "gradients";
+    case Item::Hessian:
+      return "hessian";
+    case Item::AtomicCharges:
+      return "atomic_charges";
+    case Item::IntegralExports:
+      return "integral_exports";
+    case Item::DensityExports:
+      return "density_exports";
+    case Item::BondOrders:
+      return "bond_orders";
+    case Item::Thermochemistry:
+      return "thermochemistry";
+  }
+  return "";
+}
+
+bool PropertyPlanner::isValid(Item item) const {
+  return _valid.count(item) > 0;
+}
+
+void PropertyPlanner::markRecomputed(Item item) {
+  _valid.insert(item);
+  _recomputed.push_back(item);
+}
+
+void PropertyPlanner::markReused(Item item) {
+  _reused.push_back(item);
+}
+
+void PropertyPlanner::invalidate() {
+  _valid.clear();
+}
+
+void PropertyPlanner::invalidate(Item item) {
+  _valid.erase(item);
+  for (const auto other : allItems) {
+    if (dependsOn(other, item)) {
+      _valid.erase(other);
+    }
+  }
+}
+
+void PropertyPlanner::startCalculation() {
+  _recomputed.clear();
+  _reused.clear();
+}
+
+} /* namespace Serenity */
+} /* namespace Scine */
@@ -0,0 +1,94 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef SERENITY_PROPERTYPLANNER_H_
+#define SERENITY_PROPERTYPLANNER_H_
+
+/* Scine Includes */
+#include <Utils/CalculatorBasics/PropertyList.h>
+/* External Includes */
+#include <set>
+#include <string>
+#include <vector>
+
+namespace Scine {
+namespace Serenity {
+
+/**
+ * @brief Maps required properties onto the work items producing them and keeps track of
+ *        which items are up to date for the current geometry and settings.
+ *
+ * The items form a small DAG, e.g. bond orders need the density matrix and the overlap
+ * matrix, which in turn need the SCF (density) or nothing at all (overlap).
+ * An item stays valid until it or one of its dependencies is invalidated.
+ */
+class PropertyPlanner {
+ public:
+  /// @brief The work items, in an order compatible with their dependencies.
+  enum class Item {
+    /// @brief The SCF (and any correlation treatment on top of it): Energy.
+    Scf,
+    /// @brief Gradients.
+    Gradients,
+    /// @brief AtomicCharges.
+    AtomicCharges,
+    /// @brief AOtoAtomMapping, OverlapMatrix and OneElectronMatrix.
+    IntegralExports,
+    /// @brief DensityMatrix and ElectronicOccupation.
+    DensityExports,
+    /// @brief BondOrderMatrix.
+    BondOrders,
+    /// @brief Hessian, last among the items using the electronic structure of the current system.
+    Hessian,
+    /// @brief Thermochemistry.
+    Thermochemistry
+  };
+  /**
+   * @brief Determines the items needed for the required properties.
+   *
+   * A Hessian is always accompanied by the thermochemistry derived from it.
+   * @param required The required properties.
+   * @return std::vector<Item> The items including all dependencies, dependencies first.
+   */
+  static std::vector<Item> plan(const Utils::PropertyList& required);
+  /// @brief The items an item directly depends on.
+  static std::vector<Item> dependencies(Item item);
+  /// @brief The properties produced by an item.
+  static std::vector<Utils::Property> outputs(Item item);
+  /// @brief A lower case name of an item, e.g. 'scf'.
+  static std::string name(Item item);
+
+  /// @brief Whether the item is up to date.
+  bool isValid(Item item) const;
+  /// @brief Marks the item as (re)computed and up to date.
+  void markRecomputed(Item item);
+  /// @brief Marks the item as reused.
+  void markReused(Item item);
+  /// @brief Invalidates all items.
+  void invalidate();
+  /// @brief Invalidates an item and all items depending on it.
+  void invalidate(Item item);
+  /// @brief Forgets which items were recomputed or reused in the last calculation.
+  void startCalculation();
+  /// @brief The items recomputed in the current/last calculation.
+  const std::vector<Item>& recomputed() const {
+    return _recomputed;
+  }
+  /// @brief The items reused in the current/last calculation.
+  const std::vector<Item>& reused() const {
+    return _reused;
+  }
+
+ private:
+  std::set<Item> _valid;
+  std::vector<Item> _recomputed;
+  std::vector<Item> _reused;
+};
+
+} /* namespace Serenity */
+} /* namespace Scine */
+
+#endif /* SERENITY_PROPERTYPLANNER_H_ */
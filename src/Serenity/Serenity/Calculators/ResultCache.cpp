@@ -0,0 +1,60 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+/* Wrapper Includes */
+#include "Serenity/Calculators/ResultCache.h"
+
+namespace Scine {
+namespace Serenity {
+
+ResultCache::ResultCache(unsigned int capacity) : _capacity(capacity) {
+}
+
+std::list<ResultCache::Entry>::iterator ResultCache::locate(const std::string& key,
+                                                            const Utils::PositionCollection& positions) {
+  for (auto entry = _entries.begin(); entry != _entries.end(); ++entry) {
+    if (entry->key == key && entry->positions.rows() == positions.rows() && entry->positions == positions) {
+      return entry;
+    }
+  }
+  return _entries.end();
+}
+
+std::shared_ptr<const Utils::Results> ResultCache::find(const std::string& key, const Utils::PositionCollection& positions) {
+  auto entry = this->locate(key, positions);
+  if (entry == _entries.end()) {
+    return nullptr;
+  }
+  _entries.splice(_entries.begin(), _entries, entry);
+  return _entries.front().results;
+}
+
+void ResultCache::store(const std::string& key, const Utils::PositionCollection& positions,
+                        std::shared_ptr<const Utils::Results> results) {
+  if (_capacity == 0) {
+    return;
+  }
+  auto entry = this->locate(key, positions);
+  if (entry != _entries.end()) {
+    _entries.erase(entry);
+  }
+  _entries.push_front(Entry{key, positions, std::move(results)});
+  this->setCapacity(_capacity);
+}
+
+void ResultCache::setCapacity(unsigned int capacity) {
+  _capacity = capacity;
+  while (_entries.size() > _capacity) {
+    _entries.pop_back();
+  }
+}
+
+void ResultCache::clear() {
+  _entries.clear();
+}
+
+} /* namespace Serenity */
+} /* namespace Scine */
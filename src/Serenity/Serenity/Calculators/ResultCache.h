@@ -0,0 +1,78 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef SERENITY_RESULTCACHE_H_
+#define SERENITY_RESULTCACHE_H_
+
+/* Scine Includes */
+#include <Utils/CalculatorBasics/Results.h>
+#include <Utils/Typenames.h>
+/* External Includes */
+#include <list>
+#include <memory>
+#include <string>
+
+namespace Scine {
+namespace Serenity {
+
+/**
+ * @brief An in-memory cache of the results of the last few geometries of one calculator.
+ *
+ * Entries are identified by a key describing everything but the positions (elements,
+ * settings, ...) and by the exact positions; nearby positions are never matched. Once
+ * more entries than the capacity are stored, the least recently used ones are removed.
+ */
+class ResultCache {
+ public:
+  /**
+   * @brief Constructor.
+   * @param capacity The maximal number of entries, 0 disables the cache.
+   */
+  explicit ResultCache(unsigned int capacity = 0);
+  /**
+   * @brief Looks up the results of the given positions.
+   * @param key       The key describing the structure except for the positions.
+   * @param positions The positions.
+   * @return std::shared_ptr<const Utils::Results> The results, nullptr if there are none.
+   */
+  std::shared_ptr<const Utils::Results> find(const std::string& key, const Utils::PositionCollection& positions);
+  /**
+   * @brief Stores the results of the given positions, replacing a previous entry of the same positions.
+   * @param key       The key describing the structure except for the positions.
+   * @param positions The positions.
+   * @param results   The results.
+   */
+  void store(const std::string& key, const Utils::PositionCollection& positions,
+             std::shared_ptr<const Utils::Results> results);
+  /// @brief Sets the maximal number of entries, evicting the least recently used ones if required.
+  void setCapacity(unsigned int capacity);
+  /// @brief Getter for the maximal number of entries.
+  unsigned int getCapacity() const {
+    return _capacity;
+  }
+  /// @brief Getter for the number of entries.
+  unsigned int size() const {
+    return static_cast<unsigned int>(_entries.size());
+  }
+  /// @brief Removes all entries.
+  void clear();
+
+ private:
+  struct Entry {
+    std::string key;
+    Utils::PositionCollection positions;
+    std::shared_ptr<const Utils::Results> results;
+  };
+  std::list<Entry>::iterator locate(const std::string& key, const Utils::PositionCollection& positions);
+  // Most recently used first
+  std::list<Entry> _entries;
+  unsigned int _capacity;
+};
+
+} /* namespace Serenity */
+} /* namespace Scine */
+
+#endif /* SERENITY_RESULTCACHE_H_ */
@@ -26,8 +26,9 @@ std::string toString(T& field) {
   return ret;
 }
 
-ScineSettings::ScineSettings() : Settings("SerenityDFTSettings") {
+ScineSettings::ScineSettings(const std::vector<Group>& groups) : Settings("SerenityDFTSettings") {
   auto defaults = Sty::Settings();
+  auto uses = [&groups](Group group) { return std::find(groups.begin(), groups.end(), group) != groups.end(); };
 
   using namespace Scine::Utils::UniversalSettings;
 
@@ -36,6 +37,213 @@ ScineSettings::ScineSettings() : Settings("SerenityDFTSettings") {
   show_serenity_output.setDefaultValue(false);
   this->_fields.push_back("show_serenity_output", show_serenity_output);
 
+  IntDescriptor displacement_workers("The number of displaced geometries calculated concurrently in numerical derivatives.");
+  displacement_workers.setDefaultValue(1);
+  displacement_workers.setMinimum(1);
+  this->_fields.push_back("displacement_workers", displacement_workers);
+
+  IntDescriptor displacement_threads_per_worker(
+      "The number of OpenMP threads per concurrently calculated displacement, 0 splits all threads evenly.");
+  displacement_threads_per_worker.setDefaultValue(0);
+  displacement_threads_per_worker.setMinimum(0);
+  this->_fields.push_back("displacement_threads_per_worker", displacement_threads_per_worker);
+
+  DoubleDescriptor displacement_timeout("The wall time (in seconds) per displaced geometry after which a worker process "
+                                        "is killed and the calculation fails, 0 waits forever.");
+  displacement_timeout.setDefaultValue(3600.0);
+  displacement_timeout.setMinimum(0.0);
+  this->_fields.push_back("displacement_timeout", displacement_timeout);
+
+  if (uses(Group::NumericalGradients)) {
+    DoubleDescriptor numerical_gradient_step(
+        "The displacement (in bohr) of the central finite differences used for gradients of models without "
+        "analytic gradients (CC, MP2).");
+    numerical_gradient_step.setDefaultValue(5.0e-3);
+    numerical_gradient_step.setMinimum(1.0e-5);
+    this->_fields.push_back("numerical_gradient_step", numerical_gradient_step);
+  }
+
+  // Local correlation, Serenity's PNO settings
+  if (uses(Group::LocalCorrelation)) {
+    OptionListDescriptor dlpno_accuracy("The preset of the DLPNO truncation thresholds (Serenity's PNO settings).");
+    dlpno_accuracy.addOption("loose");
+    dlpno_accuracy.addOption("normal");
+    dlpno_accuracy.addOption("tight");
+    dlpno_accuracy.setDefaultOption("normal");
+    this->_fields.push_back("dlpno_accuracy", dlpno_accuracy);
+
+    DoubleDescriptor dlpno_pno_threshold("The occupation number cutoff of the PNOs, 0 uses the dlpno_accuracy preset.");
+    dlpno_pno_threshold.setDefaultValue(0.0);
+    dlpno_pno_threshold.setMinimum(0.0);
+    this->_fields.push_back("dlpno_pno_threshold", dlpno_pno_threshold);
+
+    DoubleDescriptor dlpno_pno_core_scaling(
+        "The scaling of the PNO cutoff for pairs of core orbitals, 0 uses the dlpno_accuracy preset.");
+    dlpno_pno_core_scaling.setDefaultValue(0.0);
+    dlpno_pno_core_scaling.setMinimum(0.0);
+    this->_fields.push_back("dlpno_pno_core_scaling", dlpno_pno_core_scaling);
+
+    DoubleDescriptor dlpno_pair_threshold(
+        "The prescreening threshold of the pair energies for the CCSD treatment, 0 uses the dlpno_accuracy preset.");
+    dlpno_pair_threshold.setDefaultValue(0.0);
+    dlpno_pair_threshold.setMinimum(0.0);
+    this->_fields.push_back("dlpno_pair_threshold", dlpno_pair_threshold);
+
+    DoubleDescriptor dlpno_doi_pao_threshold(
+        "The differential overlap cutoff of the PAO domains, 0 uses the dlpno_accuracy preset.");
+    dlpno_doi_pao_threshold.setDefaultValue(0.0);
+    dlpno_doi_pao_threshold.setMinimum(0.0);
+    this->_fields.push_back("dlpno_doi_pao_threshold", dlpno_doi_pao_threshold);
+
+    DoubleDescriptor dlpno_mulliken_threshold(
+        "The Mulliken population cutoff of the fitting domains, 0 uses the dlpno_accuracy preset.");
+    dlpno_mulliken_threshold.setDefaultValue(0.0);
+    dlpno_mulliken_threshold.setMinimum(0.0);
+    this->_fields.push_back("dlpno_mulliken_threshold", dlpno_mulliken_threshold);
+
+    DoubleDescriptor dlpno_orbital_to_shell_threshold(
+        "The cutoff of the orbital to shell maps, 0 uses the dlpno_accuracy preset.");
+    dlpno_orbital_to_shell_threshold.setDefaultValue(0.0);
+    dlpno_orbital_to_shell_threshold.setMinimum(0.0);
+    this->_fields.push_back("dlpno_orbital_to_shell_threshold", dlpno_orbital_to_shell_threshold);
+  }
+
+  if (uses(Group::MP2)) {
+    DoubleDescriptor mp2_same_spin_scaling(
+        "The scaling of the same-spin MP2 correlation energy, only used by methods without 'scs-' or 'sos-' prefix.");
+    mp2_same_spin_scaling.setDefaultValue(1.0);
+    mp2_same_spin_scaling.setMinimum(0.0);
+    this->_fields.push_back("mp2_same_spin_scaling", mp2_same_spin_scaling);
+
+    DoubleDescriptor mp2_opposite_spin_scaling(
+        "The scaling of the opposite-spin MP2 correlation energy, only used by methods without 'scs-' or 'sos-' "
+        "prefix.");
+    mp2_opposite_spin_scaling.setDefaultValue(1.0);
+    mp2_opposite_spin_scaling.setMinimum(0.0);
+    this->_fields.push_back("mp2_opposite_spin_scaling", mp2_opposite_spin_scaling);
+  }
+
+  if (uses(Group::Embedding)) {
+    StringDescriptor embedding_active_atoms(
+        "The indices of the atoms in the active embedding subsystem (e.g. '0,3-5').");
+    embedding_active_atoms.setDefaultValue("");
+    this->_fields.push_back("embedding_active_atoms", embedding_active_atoms);
+
+    OptionListDescriptor embedding_mode(
+        "Whether both subsystem densities are relaxed ('freeze_and_thaw') or the isolated environment density is "
+        "kept frozen ('frozen_environment', without gradients).");
+    embedding_mode.addOption("freeze_and_thaw");
+    embedding_mode.addOption("frozen_environment");
+    embedding_mode.setDefaultOption("freeze_and_thaw");
+    this->_fields.push_back("embedding_mode", embedding_mode);
+
+    IntDescriptor embedding_environment_charge(
+        "The charge of the environment subsystem, the active one carries the rest.");
+    embedding_environment_charge.setDefaultValue(0);
+    this->_fields.push_back("embedding_environment_charge", embedding_environment_charge);
+
+    IntDescriptor embedding_environment_spin_multiplicity(
+        "The spin multiplicity of the environment subsystem, the active one carries the other unpaired electrons.");
+    embedding_environment_spin_multiplicity.setDefaultValue(1);
+    embedding_environment_spin_multiplicity.setMinimum(1);
+    this->_fields.push_back("embedding_environment_spin_multiplicity", embedding_environment_spin_multiplicity);
+
+    IntDescriptor embedding_max_cycles("The maximal number of freeze-and-thaw cycles.");
+    embedding_max_cycles.setDefaultValue(50);
+    embedding_max_cycles.setMinimum(1);
+    this->_fields.push_back("embedding_max_cycles", embedding_max_cycles);
+
+    DoubleDescriptor embedding_convergence("The convergence threshold of the freeze-and-thaw cycles.");
+    embedding_convergence.setDefaultValue(1e-6);
+    embedding_convergence.setMinimum(0.0);
+    this->_fields.push_back("embedding_convergence", embedding_convergence);
+  }
+
+  DoubleDescriptor sparse_matrix_threshold("Screens the required density and overlap matrices by this threshold into "
+                                           "sparse (CSR) form replacing the dense results, and prunes the bond orders. "
+                                           "The results then lack these required properties. "
+                                           "0 turns the screening off.");
+  sparse_matrix_threshold.setDefaultValue(0.0);
+  sparse_matrix_threshold.setMinimum(0.0);
+  this->_fields.push_back("sparse_matrix_threshold", sparse_matrix_threshold);
+
+  StringDescriptor scratch_directory("The directory for Serenity's scratch files, defaults to './serenity_tmp/'.");
+  scratch_directory.setDefaultValue("");
+  this->_fields.push_back("scratch_directory", scratch_directory);
+
+  DoubleDescriptor scratch_memory_limit(
+      "The size (in MB) of scratch files kept in RAM (/dev/shm) before new systems spill over to the scratch "
+      "directory. Checked when a system is set up, the files of a system in RAM may grow beyond it.");
+  scratch_memory_limit.setDefaultValue(0.0);
+  scratch_memory_limit.setMinimum(0.0);
+  this->_fields.push_back("scratch_memory_limit", scratch_memory_limit);
+
+  DoubleDescriptor state_memory_limit(
+      "The memory (in MB) the states of one calculator may hold on their own before the least recently taken ones are "
+      "written to disk.");
+  state_memory_limit.setDefaultValue(4096.0);
+  state_memory_limit.setMinimum(0.0);
+  this->_fields.push_back("state_memory_limit", state_memory_limit);
+
+  BoolDescriptor warm_clone("Switch: clones share basis, grids and integrals with the original and start from its orbitals.");
+  warm_clone.setDefaultValue(false);
+  this->_fields.push_back("warm_clone", warm_clone);
+
+  OptionListDescriptor guess_extrapolation("The SCF guess built from the orbitals of previous geometries.");
+  guess_extrapolation.addOption("none");
+  guess_extrapolation.addOption("projected");
+  guess_extrapolation.addOption("aspc");
+  guess_extrapolation.setDefaultOption("projected");
+  this->_fields.push_back("guess_extrapolation", guess_extrapolation);
+
+  IntDescriptor guess_extrapolation_order("The order of the 'aspc' extrapolation, using order + 2 previous geometries.");
+  guess_extrapolation_order.setDefaultValue(3);
+  guess_extrapolation_order.setMinimum(0);
+  guess_extrapolation_order.setMaximum(6);
+  this->_fields.push_back("guess_extrapolation_order", guess_extrapolation_order);
+
+  DoubleDescriptor guess_min_overlap(
+      "The smallest eigenvalue of the overlap of the previous occupied orbitals at the new geometry for them to be reused.");
+  guess_min_overlap.setDefaultValue(0.5);
+  guess_min_overlap.setMinimum(0.0);
+  guess_min_overlap.setMaximum(1.0);
+  this->_fields.push_back("guess_min_overlap", guess_min_overlap);
+
+  StringDescriptor guess_cache_directory(
+      "The directory of an on-disk cache of converged orbitals shared between processes, disabled if empty.");
+  guess_cache_directory.setDefaultValue("");
+  this->_fields.push_back("guess_cache_directory", guess_cache_directory);
+
+  DoubleDescriptor guess_cache_size("The maximal size (in MB) of the guess cache.");
+  guess_cache_size.setDefaultValue(1024.0);
+  guess_cache_size.setMinimum(0.0);
+  this->_fields.push_back("guess_cache_size", guess_cache_size);
+
+  DoubleDescriptor guess_cache_tolerance(
+      "The largest displacement (in bohr) of any atom for cached orbitals of another geometry to be used as guess.");
+  guess_cache_tolerance.setDefaultValue(0.1);
+  guess_cache_tolerance.setMinimum(0.0);
+  this->_fields.push_back("guess_cache_tolerance", guess_cache_tolerance);
+
+  IntDescriptor result_cache_size(
+      "The number of geometries whose results are kept for repeated calculations, 0 disables (and clears) the cache.");
+  result_cache_size.setDefaultValue(0);
+  result_cache_size.setMinimum(0);
+  this->_fields.push_back("result_cache_size", result_cache_size);
+
+  OptionListDescriptor atomic_charge_model("The model of the atomic charges.");
+  atomic_charge_model.addOption("mulliken");
+  atomic_charge_model.addOption("hirshfeld");
+  atomic_charge_model.addOption("cm5");
+  atomic_charge_model.setDefaultOption("mulliken");
+  this->_fields.push_back("atomic_charge_model", atomic_charge_model);
+
+  IntDescriptor atomic_charge_grid_block_size(
+      "The number of grid points evaluated at once for the 'hirshfeld' and 'cm5' atomic charges.");
+  atomic_charge_grid_block_size.setDefaultValue(128);
+  atomic_charge_grid_block_size.setMinimum(1);
+  this->_fields.push_back("atomic_charge_grid_block_size", atomic_charge_grid_block_size);
+
   // Generalized duplicates (higher in hierarchy than the Serenity settings)
   IntDescriptor spin_multiplicity("The multiplicity.");
   spin_multiplicity.setDefaultValue(abs(defaults.spin) + 1);
@@ -61,7 +269,8 @@ ScineSettings::ScineSettings() : Settings("SerenityDFTSettings") {
   this->_fields.push_back(SettingsNames::spinMode, spin_mode);
 
   StringDescriptor method("The actual method used.");
-  method.setDefaultValue("PBE");
+  // The MP2 calculator rejects density functionals
+  method.setDefaultValue(uses(Group::MP2) ? "ri-mp2" : "PBE");
   this->_fields.push_back(SettingsNames::method, method);
 
   StringDescriptor basis_set("The label of the basis set.");
@@ -92,12 +301,25 @@ ScineSettings::ScineSettings() : Settings("SerenityDFTSettings") {
   solvent.setDefaultValue("none");
   this->_fields.push_back(SettingsNames::solvent, solvent);
 
+  OptionListDescriptor ri_approximation("The density fitting of the Coulomb ('rij') or Coulomb and exchange ('rijk') "
+                                        "contributions, using the auxiliary bases 'basis_auxJLabel' and "
+                                        "'basis_auxJKLabel', respectively.");
+  ri_approximation.addOption("none");
+  ri_approximation.addOption("rij");
+  ri_approximation.addOption("rijk");
+  ri_approximation.setDefaultOption("rij");
+  this->_fields.push_back("ri_approximation", ri_approximation);
+
   // Serenity
   // - Basis - Block
   StringDescriptor basis_auxJLabel("Basis set label for the auxiliary basis for Coulomb integrals.");
   basis_auxJLabel.setDefaultValue(defaults.basis.auxJLabel);
   this->_fields.push_back("basis_auxJLabel", basis_auxJLabel);
 
+  StringDescriptor basis_auxJKLabel("Basis set label for the auxiliary basis for Coulomb and exchange integrals.");
+  basis_auxJKLabel.setDefaultValue(defaults.basis.auxJKLabel);
+  this->_fields.push_back("basis_auxJKLabel", basis_auxJKLabel);
+
   StringDescriptor basis_auxCLabel("Basis set label for the auxiliary basis for correlation treatments.");
   basis_auxCLabel.setDefaultValue(defaults.basis.auxCLabel);
   this->_fields.push_back("basis_auxCLabel", basis_auxCLabel);
@@ -137,6 +359,41 @@ ScineSettings::ScineSettings() : Settings("SerenityDFTSettings") {
   grid_accuracy.setMaximum(7);
   this->_fields.push_back("grid_accuracy", grid_accuracy);
 
+  BoolDescriptor adaptive_grid("Switch: use the small grid (grid_smallGridAccuracy) until the gradient norm or the energy "
+                               "change between geometries drops below its threshold, the final grid (grid_accuracy) "
+                               "afterwards. The grid used is reported in the results' description.");
+  adaptive_grid.setDefaultValue(false);
+  this->_fields.push_back("adaptive_grid", adaptive_grid);
+
+  DoubleDescriptor adaptive_grid_gradient_threshold("The gradient norm (hartree/bohr) switching to the final grid.");
+  adaptive_grid_gradient_threshold.setDefaultValue(5.0e-3);
+  adaptive_grid_gradient_threshold.setMinimum(0.0);
+  this->_fields.push_back("adaptive_grid_gradient_threshold", adaptive_grid_gradient_threshold);
+
+  DoubleDescriptor adaptive_grid_energy_threshold(
+      "The energy change (hartree) between consecutive geometries switching to the final grid.");
+  adaptive_grid_energy_threshold.setDefaultValue(1.0e-4);
+  adaptive_grid_energy_threshold.setMinimum(0.0);
+  this->_fields.push_back("adaptive_grid_energy_threshold", adaptive_grid_energy_threshold);
+
+  BoolDescriptor adaptive_scf_threshold(
+      "Switch: loosen the SCF thresholds based on the largest gradient component of the previous geometry, down to "
+      "self_consistence_criterion near stationary points. Calculations of Hessians always use the requested "
+      "thresholds. The threshold used is reported in the results' description.");
+  adaptive_scf_threshold.setDefaultValue(false);
+  this->_fields.push_back("adaptive_scf_threshold", adaptive_scf_threshold);
+
+  DoubleDescriptor adaptive_scf_factor(
+      "The factor of the squared largest gradient component giving the adaptive SCF energy threshold.");
+  adaptive_scf_factor.setDefaultValue(1.0e-3);
+  adaptive_scf_factor.setMinimum(0.0);
+  this->_fields.push_back("adaptive_scf_factor", adaptive_scf_factor);
+
+  DoubleDescriptor adaptive_scf_loosest_threshold("The loosest adaptive SCF energy threshold.");
+  adaptive_scf_loosest_threshold.setDefaultValue(1.0e-5);
+  adaptive_scf_loosest_threshold.setMinimum(0.0);
+  this->_fields.push_back("adaptive_scf_loosest_threshold", adaptive_scf_loosest_threshold);
+
   // - SCF - Block
   StringDescriptor scf_initialguess("The initial guess to be used.");
   scf_initialguess.setDefaultValue(toString(defaults.scf.initialguess));
@@ -146,6 +403,55 @@ ScineSettings::ScineSettings() : Settings("SerenityDFTSettings") {
   scf_seriesDampingInitialSteps.setDefaultValue(5);
   this->_fields.push_back("scf_seriesDampingInitialSteps", scf_seriesDampingInitialSteps);
 
+  DoubleDescriptor scf_rmsdThreshold("The convergence threshold for the RMSD of the density matrix.");
+  scf_rmsdThreshold.setDefaultValue(defaults.scf.rmsdThreshold);
+  scf_rmsdThreshold.setMinimum(0.0);
+  this->_fields.push_back("scf_rmsdThreshold", scf_rmsdThreshold);
+
+  StringDescriptor scf_damping("The damping algorithm (none, static, series, dynamic).");
+  scf_damping.setDefaultValue(toString(defaults.scf.damping));
+  this->_fields.push_back("scf_damping", scf_damping);
+
+  DoubleDescriptor scf_endDampErr("The DIIS error below which damping is turned off.");
+  scf_endDampErr.setDefaultValue(defaults.scf.endDampErr);
+  scf_endDampErr.setMinimum(0.0);
+  this->_fields.push_back("scf_endDampErr", scf_endDampErr);
+
+  BoolDescriptor scf_useLevelshift("Switch: use a level shift of the virtual orbitals in early iterations.");
+  scf_useLevelshift.setDefaultValue(defaults.scf.useLevelshift);
+  this->_fields.push_back("scf_useLevelshift", scf_useLevelshift);
+
+  DoubleDescriptor scf_minimumLevelshift("The minimal level shift (hartree).");
+  scf_minimumLevelshift.setDefaultValue(defaults.scf.minimumLevelshift);
+  scf_minimumLevelshift.setMinimum(0.0);
+  this->_fields.push_back("scf_minimumLevelshift", scf_minimumLevelshift);
+
+  IntDescriptor scf_diisMaxStore("The number of Fock matrices kept for the DIIS extrapolation.");
+  scf_diisMaxStore.setDefaultValue(defaults.scf.diisMaxStore);
+  scf_diisMaxStore.setMinimum(1);
+  this->_fields.push_back("scf_diisMaxStore", scf_diisMaxStore);
+
+  DoubleDescriptor scf_diisStartError("The error below which the DIIS extrapolation starts.");
+  scf_diisStartError.setDefaultValue(defaults.scf.diisStartError);
+  scf_diisStartError.setMinimum(0.0);
+  this->_fields.push_back("scf_diisStartError", scf_diisStartError);
+
+  DoubleDescriptor scf_diisThreshold("The threshold for the conditioning of the DIIS equations.");
+  scf_diisThreshold.setDefaultValue(defaults.scf.diisThreshold);
+  scf_diisThreshold.setMinimum(0.0);
+  this->_fields.push_back("scf_diisThreshold", scf_diisThreshold);
+
+  // - Embedding - Block
+  if (uses(Group::Embedding)) {
+    StringDescriptor emb_naddKinFunc("The non-additive kinetic energy functional of the embedding.");
+    emb_naddKinFunc.setDefaultValue(toString(defaults.embedding.naddKinFunc));
+    this->_fields.push_back("emb_naddKinFunc", emb_naddKinFunc);
+
+    StringDescriptor emb_naddXCFunc("The non-additive exchange-correlation functional of the embedding.");
+    emb_naddXCFunc.setDefaultValue(toString(defaults.embedding.naddXCFunc));
+    this->_fields.push_back("emb_naddXCFunc", emb_naddXCFunc);
+  }
+
   // - PCM - Block
   IntDescriptor pcm_alpha("The sharpness parameter for the molecular surface model function for DELLEY-type surfaces.");
   pcm_alpha.setDefaultValue(50);
@@ -163,6 +469,17 @@ ScineSettings::ScineSettings() : Settings("SerenityDFTSettings") {
   this->resetToDefaults();
 }
 
+std::string ScineSettings::scratchRoot() const {
+  std::string root = this->getString("scratch_directory");
+  if (root.empty()) {
+    return Sty::Settings().path + "serenity_tmp/";
+  }
+  if (root.back() != '/') {
+    root += "/";
+  }
+  return root;
+}
+
 void ScineSettings::applyTo(Sty::Settings& settings) {
   if (!this->valid()) {
     this->throwIncorrectSettings();
@@ -171,13 +488,15 @@ void ScineSettings::applyTo(Sty::Settings& settings) {
   std::string value;
 
   // Mandatory
-  // TODO
-  settings.path = settings.path + "serenity_tmp/";
+  settings.path = this->scratchRoot();
 
   // Serenity
   // - Basis - Block
   settings.basis.auxJLabel = this->getString("basis_auxJLabel");
   std::transform(settings.basis.auxJLabel.begin(), settings.basis.auxJLabel.end(), settings.basis.auxJLabel.begin(), ::toupper);
+  settings.basis.auxJKLabel = this->getString("basis_auxJKLabel");
+  std::transform(settings.basis.auxJKLabel.begin(), settings.basis.auxJKLabel.end(), settings.basis.auxJKLabel.begin(),
+                 ::toupper);
   settings.basis.auxCLabel = this->getString("basis_auxCLabel");
   std::transform(settings.basis.auxCLabel.begin(), settings.basis.auxCLabel.end(), settings.basis.auxCLabel.begin(), ::toupper);
   settings.basis.makeSphericalBasis = this->getBool("basis_makeSphericalBasis");
@@ -193,6 +512,22 @@ void ScineSettings::applyTo(Sty::Settings& settings) {
   value = this->getString("scf_initialguess");
   Sty::Options::resolve(value, settings.scf.initialguess);
   settings.scf.seriesDampingInitialSteps = this->getInt("scf_seriesDampingInitialSteps");
+  settings.scf.rmsdThreshold = this->getDouble("scf_rmsdThreshold");
+  value = this->getString("scf_damping");
+  Sty::Options::resolve(value, settings.scf.damping);
+  settings.scf.endDampErr = this->getDouble("scf_endDampErr");
+  settings.scf.useLevelshift = this->getBool("scf_useLevelshift");
+  settings.scf.minimumLevelshift = this->getDouble("scf_minimumLevelshift");
+  settings.scf.diisMaxStore = this->getInt("scf_diisMaxStore");
+  settings.scf.diisStartError = this->getDouble("scf_diisStartError");
+  settings.scf.diisThreshold = this->getDouble("scf_diisThreshold");
+  // - Embedding - Block
+  if (this->valueExists("emb_naddKinFunc")) {
+    value = this->getString("emb_naddKinFunc");
+    Sty::Options::resolve(value, settings.embedding.naddKinFunc);
+    value = this->getString("emb_naddXCFunc");
+    Sty::Options::resolve(value, settings.embedding.naddXCFunc);
+  }
   // Spin mode
   this->resolveSpinMode();
   value = this->getString(SettingsNames::spinMode);
@@ -223,6 +558,12 @@ void ScineSettings::applyTo(Sty::Settings& settings) {
   settings.scf.maxCycles = this->getInt(SettingsNames::maxScfIterations);
   settings.basis.label = this->getString(SettingsNames::basisSet);
   std::transform(settings.basis.label.begin(), settings.basis.label.end(), settings.basis.label.begin(), ::toupper);
+  value = this->getString("ri_approximation");
+  const auto exact = Sty::Options::DENS_FITS::NONE;
+  const auto ri = Sty::Options::DENS_FITS::RI;
+  settings.basis.densFitJ = (value == "none") ? exact : ri;
+  settings.basis.densFitK = (value == "rijk") ? ri : exact;
+  settings.basis.densFitLRK = (value == "rijk") ? ri : exact;
 }
 
 void ScineSettings::resolveSpinMode() {
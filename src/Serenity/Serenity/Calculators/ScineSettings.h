@@ -9,6 +9,9 @@
 
 /* Scine Includes */
 #include <Utils/Settings.h>
+/* External Includes */
+#include <string>
+#include <vector>
 
 namespace Serenity {
 class Settings;
@@ -23,10 +26,22 @@ namespace Serenity {
  */
 class ScineSettings : public Scine::Utils::Settings {
  public:
+  /// @brief The groups of settings only used by some of the calculators.
+  enum class Group {
+    /// 'numerical_gradient_step'
+    NumericalGradients,
+    /// 'dlpno_*'
+    LocalCorrelation,
+    /// 'mp2_*'
+    MP2,
+    /// 'embedding_*' and 'emb_*'
+    Embedding
+  };
   /**
    * @brief Construct a new ScineSettings object.
+   * @param groups The groups of settings added to the common ones.
    */
-  ScineSettings();
+  explicit ScineSettings(const std::vector<Group>& groups = {});
   /**
    * @brief Applies these SCINE style settings to the Serenity style settings.
    * @param settings The Serenity style settings.
@@ -36,6 +51,11 @@ class ScineSettings : public Scine::Utils::Settings {
    * @brief If spin mode is set to 'any', this selects a fitting serenity spin mode depending on the spin multiplicity
    */
   void resolveSpinMode();
+  /**
+   * @brief The root directory on disk for the scratch files of all systems ('scratch_directory').
+   * @return std::string The directory, with trailing '/'.
+   */
+  std::string scratchRoot() const;
 };
 
 } /* namespace Serenity */
@@ -0,0 +1,184 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+/* Wrapper Includes */
+#include "Serenity/Calculators/ScratchManager.h"
+/* Scine Includes */
+#include <Utils/Technical/UniqueIdentifier.h>
+/* External Includes */
+#include <boost/filesystem.hpp>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#  include <cerrno>
+#  include <csignal>
+#  include <unistd.h>
+#endif
+
+namespace Scine {
+namespace Serenity {
+
+namespace {
+/*
+ * Counts the files and their sizes in a directory (recursively).
+ */
+void measure(const std::string& path, unsigned long& files, unsigned long long& bytes) {
+  boost::system::error_code ec;
+  if (!boost::filesystem::is_directory(path, ec)) {
+    return;
+  }
+  for (boost::filesystem::recursive_directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+    if (boost::filesystem::is_regular_file(it->path(), ec)) {
+      ++files;
+      bytes += boost::filesystem::file_size(it->path(), ec);
+    }
+  }
+}
+
+std::string withTrailingSlash(std::string path) {
+  if (path.empty()) {
+    return "./";
+  }
+  if (path.back() != '/') {
+    path += "/";
+  }
+  return path;
+}
+
+std::string ramRoot() {
+#ifdef _WIN32
+  return "";
+#else
+  boost::system::error_code ec;
+  if (!boost::filesystem::is_directory("/dev/shm", ec)) {
+    return "";
+  }
+  return "/dev/shm/serenity_" + std::to_string(getpid()) + "/";
+#endif
+}
+
+/*
+ * Removes the RAM roots of processes that are gone, their directories are never
+ * released otherwise.
+ */
+void removeStaleRamRoots() {
+#ifndef _WIN32
+  const std::string prefix = "serenity_";
+  boost::system::error_code ec;
+  std::vector<boost::filesystem::path> stale;
+  for (boost::filesystem::directory_iterator it("/dev/shm", ec), end; !ec && it != end; it.increment(ec)) {
+    const std::string name = it->path().filename().string();
+    if (name.compare(0, prefix.size(), prefix) != 0 || name.size() == prefix.size() ||
+        name.find_first_not_of("0123456789", prefix.size()) != std::string::npos) {
+      continue;
+    }
+    const auto pid = static_cast<pid_t>(std::stol(name.substr(prefix.size())));
+    if (pid != getpid() && kill(pid, 0) != 0 && errno == ESRCH) {
+      stale.push_back(it->path());
+    }
+  }
+  for (const auto& path : stale) {
+    boost::filesystem::remove_all(path, ec);
+  }
+#endif
+}
+} // namespace
+
+ScratchManager::Directory::Directory(std::string root, std::string name, bool inMemory)
+  : _root(std::move(root)), _name(std::move(name)), _inMemory(inMemory) {
+}
+
+ScratchManager::Directory::~Directory() {
+  ScratchManager::getInstance().release(*this);
+}
+
+ScratchManager::ScratchManager() : _ramRoot(ramRoot()) {
+  if (!_ramRoot.empty()) {
+    removeStaleRamRoots();
+  }
+}
+
+ScratchManager::~ScratchManager() {
+  // Only succeeds if all RAM-backed directories are gone
+  if (!_ramRoot.empty()) {
+    boost::system::error_code ec;
+    boost::filesystem::remove(_ramRoot, ec);
+  }
+}
+
+ScratchManager& ScratchManager::getInstance() {
+  static ScratchManager instance;
+  return instance;
+}
+
+std::shared_ptr<const ScratchManager::Directory> ScratchManager::acquire(const std::string& diskRoot, double ramLimit) {
+  Scine::Utils::UniqueIdentifier uid;
+  const std::string name = uid.getStringRepresentation();
+  std::string root = withTrailingSlash(diskRoot);
+  bool inMemory = false;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (ramLimit > 0.0 && !_ramRoot.empty()) {
+    unsigned long files = 0;
+    unsigned long long bytes = 0;
+    for (const auto& path : _aliveInMemory) {
+      measure(path, files, bytes);
+    }
+    if (static_cast<double>(bytes) < ramLimit * 1024.0 * 1024.0) {
+      root = _ramRoot;
+      inMemory = true;
+    }
+  }
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(root, ec);
+  if (ec && inMemory) {
+    // Fall back to the disk
+    root = withTrailingSlash(diskRoot);
+    inMemory = false;
+    boost::filesystem::create_directories(root, ec);
+  }
+  // Not using std::make_shared, the constructor is private
+  std::shared_ptr<const Directory> directory(new Directory(root, name, inMemory));
+  _alive.insert(directory->path());
+  if (inMemory) {
+    _aliveInMemory.insert(directory->path());
+  }
+  return directory;
+}
+
+void ScratchManager::release(const Directory& directory) {
+  const std::string path = directory.path();
+  unsigned long files = 0;
+  unsigned long long bytes = 0;
+  measure(path, files, bytes);
+  boost::system::error_code ec;
+  boost::filesystem::remove_all(path, ec);
+  std::lock_guard<std::mutex> lock(_mutex);
+  _alive.erase(path);
+  _aliveInMemory.erase(path);
+  ++_directoriesReleased;
+  _bytesReleased += bytes;
+}
+
+ScratchManager::Statistics ScratchManager::statistics() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  Statistics stats;
+  stats.directoriesAlive = _alive.size();
+  stats.directoriesInMemory = _aliveInMemory.size();
+  for (const auto& path : _alive) {
+    measure(path, stats.filesAlive, stats.bytesAlive);
+  }
+  unsigned long files = 0;
+  for (const auto& path : _aliveInMemory) {
+    measure(path, files, stats.bytesInMemory);
+  }
+  stats.directoriesReleased = _directoriesReleased;
+  stats.bytesReleased = _bytesReleased;
+  return stats;
+}
+
+} /* namespace Serenity */
+} /* namespace Scine */
@@ -0,0 +1,115 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+#ifndef SERENITY_SCRATCHMANAGER_H_
+#define SERENITY_SCRATCHMANAGER_H_
+
+/* External Includes */
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace Scine {
+namespace Serenity {
+
+/**
+ * @brief Hands out and cleans up the scratch directories of all Serenity systems in this process.
+ *
+ * Serenity writes the files of a system into '<settings.path><settings.name>/'.
+ * Each system created by the wrapper reserves such a directory through acquire(); the
+ * directory is removed as soon as the last handle to it (held by the calculator and by any
+ * state spilled into it) is gone.
+ *
+ * If a RAM limit is given, directories are placed on '/dev/shm' for as long as the RAM-backed
+ * directories alive stay below that limit; further directories spill over to the disk root.
+ * The limit is only checked when a directory is acquired: a directory placed in RAM stays
+ * there, even if its files grow beyond the limit later on.
+ * The RAM root is specific to the process that first used the manager, it is removed again
+ * at exit once empty. RAM roots left behind by processes that no longer exist (e.g. after a
+ * crash) are removed when the manager is first used.
+ */
+class ScratchManager {
+ public:
+  /**
+   * @brief A reserved scratch directory, removed upon destruction.
+   */
+  class Directory {
+   public:
+    ~Directory();
+    Directory(const Directory& other) = delete;
+    Directory& operator=(const Directory& other) = delete;
+    /// @brief The directory to be used as Serenity's settings.path (with trailing '/').
+    const std::string& root() const {
+      return _root;
+    }
+    /// @brief The unique name to be used as Serenity's settings.name.
+    const std::string& name() const {
+      return _name;
+    }
+    /// @brief The directory of the system itself (with trailing '/').
+    std::string path() const {
+      return _root + _name + "/";
+    }
+    /// @brief Whether the directory is RAM-backed.
+    bool inMemory() const {
+      return _inMemory;
+    }
+
+   private:
+    friend class ScratchManager;
+    Directory(std::string root, std::string name, bool inMemory);
+    std::string _root;
+    std::string _name;
+    bool _inMemory;
+  };
+
+  /// @brief Usage statistics of the scratch directories.
+  struct Statistics {
+    /// @brief The number of directories currently reserved.
+    unsigned long directoriesAlive = 0;
+    /// @brief The number of those directories that are RAM-backed.
+    unsigned long directoriesInMemory = 0;
+    /// @brief The number of files in the reserved directories.
+    unsigned long filesAlive = 0;
+    /// @brief The size of the files in the reserved directories in bytes.
+    unsigned long long bytesAlive = 0;
+    /// @brief The size of the files in the RAM-backed directories in bytes.
+    unsigned long long bytesInMemory = 0;
+    /// @brief The number of directories removed so far.
+    unsigned long directoriesReleased = 0;
+    /// @brief The size of the files removed so far in bytes.
+    unsigned long long bytesReleased = 0;
+  };
+
+  /// @brief Getter for the process-wide instance.
+  static ScratchManager& getInstance();
+  /**
+   * @brief Reserves a new scratch directory.
+   * @param diskRoot The root directory on disk, created if missing.
+   * @param ramLimit The maximal size (in MB) of all RAM-backed directories, 0 disables them.
+   * @return std::shared_ptr<const Directory> The handle to the reserved directory.
+   */
+  std::shared_ptr<const Directory> acquire(const std::string& diskRoot, double ramLimit);
+  /// @brief Collects the current statistics; walks all reserved directories.
+  Statistics statistics() const;
+
+ private:
+  ScratchManager();
+  ~ScratchManager();
+  void release(const Directory& directory);
+  const std::string _ramRoot;
+  mutable std::mutex _mutex;
+  std::set<std::string> _alive;
+  std::set<std::string> _aliveInMemory;
+  unsigned long _directoriesReleased = 0;
+  unsigned long long _bytesReleased = 0;
+};
+
+} /* namespace Serenity */
+} /* namespace Scine */
+
+#endif /* SERENITY_SCRATCHMANAGER_H_ */
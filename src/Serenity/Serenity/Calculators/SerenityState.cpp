@@ -0,0 +1,295 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+/* Wrapper Includes */
+#include "Serenity/Calculators/SerenityState.h"
+/* Scine Includes */
+#include <Utils/Technical/UniqueIdentifier.h>
+/* External Includes */
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace Scine {
+namespace Serenity {
+
+namespace {
+void writeOrbitals(std::ofstream& out, const SerenityState::OrbitalData& data) {
+  const auto nSpins = static_cast<unsigned int>(data.coefficients.size());
+  out.write(reinterpret_cast<const char*>(&nSpins), sizeof(nSpins));
+  for (unsigned int i = 0; i < nSpins; ++i) {
+    const Eigen::MatrixXd::Index rows = data.coefficients[i].rows();
+    const Eigen::MatrixXd::Index cols = data.coefficients[i].cols();
+    const Eigen::VectorXd::Index nEigenvalues = data.eigenvalues[i].size();
+    out.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+    out.write(reinterpret_cast<const char*>(&cols), sizeof(cols));
+    out.write(reinterpret_cast<const char*>(data.coefficients[i].data()), rows * cols * sizeof(double));
+    out.write(reinterpret_cast<const char*>(&nEigenvalues), sizeof(nEigenvalues));
+    out.write(reinterpret_cast<const char*>(data.eigenvalues[i].data()), nEigenvalues * sizeof(double));
+    out.write(reinterpret_cast<const char*>(&data.nCoreOrbitals[i]), sizeof(unsigned int));
+    out.write(reinterpret_cast<const char*>(&data.nOccupiedOrbitals[i]), sizeof(unsigned int));
+  }
+}
+
+std::shared_ptr<const SerenityState::OrbitalData> readOrbitals(std::ifstream& in) {
+  unsigned int nSpins = 0;
+  in.read(reinterpret_cast<char*>(&nSpins), sizeof(nSpins));
+  std::vector<Eigen::MatrixXd> coefficients(nSpins);
+  std::vector<Eigen::VectorXd> eigenvalues(nSpins);
+  std::vector<unsigned int> nCore(nSpins);
+  std::vector<unsigned int> nOcc(nSpins);
+  for (unsigned int i = 0; i < nSpins; ++i) {
+    Eigen::MatrixXd::Index rows = 0;
+    Eigen::MatrixXd::Index cols = 0;
+    Eigen::VectorXd::Index nEigenvalues = 0;
+    in.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+    in.read(reinterpret_cast<char*>(&cols), sizeof(cols));
+    coefficients[i].resize(rows, cols);
+    in.read(reinterpret_cast<char*>(coefficients[i].data()), rows * cols * sizeof(double));
+    in.read(reinterpret_cast<char*>(&nEigenvalues), sizeof(nEigenvalues));
+    eigenvalues[i].resize(nEigenvalues);
+    in.read(reinterpret_cast<char*>(eigenvalues[i].data()), nEigenvalues * sizeof(double));
+    in.read(reinterpret_cast<char*>(&nCore[i]), sizeof(unsigned int));
+    in.read(reinterpret_cast<char*>(&nOcc[i]), sizeof(unsigned int));
+  }
+  if (!in) {
+    throw std::runtime_error("Failed to read a spilled Serenity state.");
+  }
+  return std::make_shared<SerenityState::OrbitalData>(std::move(coefficients), std::move(eigenvalues),
+                                                      std::move(nCore), std::move(nOcc));
+}
+} // namespace
+
+SerenityState::OrbitalData::OrbitalData(std::vector<Eigen::MatrixXd> coefficients, std::vector<Eigen::VectorXd> eigenvalues,
+                                        std::vector<unsigned int> nCoreOrbitals, std::vector<unsigned int> nOccupiedOrbitals)
+  : coefficients(std::move(coefficients)),
+    eigenvalues(std::move(eigenvalues)),
+    nCoreOrbitals(std::move(nCoreOrbitals)),
+    nOccupiedOrbitals(std::move(nOccupiedOrbitals)),
+    _bytes(0) {
+  for (unsigned int i = 0; i < this->coefficients.size(); ++i) {
+    _bytes += (this->coefficients[i].size() + this->eigenvalues[i].size()) * sizeof(double);
+  }
+}
+
+SerenityState::SerenityState(std::vector<std::string> symbols, Eigen::MatrixXd coordinates,
+                             std::shared_ptr<const OrbitalData> restricted, std::shared_ptr<const OrbitalData> unrestricted)
+  : _symbols(std::move(symbols)),
+    _coordinates(std::move(coordinates)),
+    _restricted(std::move(restricted)),
+    _unrestricted(std::move(unrestricted)),
+    _hasRestricted(_restricted != nullptr),
+    _hasUnrestricted(_unrestricted != nullptr) {
+}
+
+SerenityState::~SerenityState() {
+  if (!_file.empty()) {
+    std::remove(_file.c_str());
+  }
+}
+
+std::shared_ptr<const SerenityState::OrbitalData> SerenityState::getRestrictedOrbitals() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_restricted || !_hasRestricted) {
+    return _restricted;
+  }
+  return this->read(true);
+}
+
+std::shared_ptr<const SerenityState::OrbitalData> SerenityState::getUnrestrictedOrbitals() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (_unrestricted || !_hasUnrestricted) {
+    return _unrestricted;
+  }
+  return this->read(false);
+}
+
+bool SerenityState::isSpilled() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return !_file.empty();
+}
+
+void SerenityState::spill(const std::string& file, std::shared_ptr<const ScratchManager::Directory> directory) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_file.empty()) {
+    return;
+  }
+  std::ofstream out(file, std::ios::binary);
+  // The restricted block (if any) is always written first
+  if (_restricted) {
+    writeOrbitals(out, *_restricted);
+  }
+  if (_unrestricted) {
+    writeOrbitals(out, *_unrestricted);
+  }
+  out.close();
+  if (!out) {
+    // Keep the orbitals in memory if they can not be written
+    std::remove(file.c_str());
+    return;
+  }
+  _file = file;
+  _directory = std::move(directory);
+  _restricted = nullptr;
+  _unrestricted = nullptr;
+}
+
+void SerenityState::Tracker::track(const std::shared_ptr<SerenityState>& state,
+                                   std::shared_ptr<const ScratchManager::Directory> directory) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  // States already gone (or their scratch directory) have nothing left to spill
+  _states.remove_if([](const TrackedState& tracked) { return tracked.state.expired() || tracked.directory.expired(); });
+  _states.push_back({state, std::move(directory)});
+}
+
+bool SerenityState::Tracker::spillLeastRecent(size_t limit) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto holders = this->holders();
+  auto it = _states.begin();
+  while (it != _states.end() && bytes(holders) > limit) {
+    auto state = it->state.lock();
+    auto directory = it->directory.lock();
+    if (!state || !directory) {
+      it = _states.erase(it);
+      continue;
+    }
+    // Orbitals shared with the calculator stay in memory anyway
+    if (!isReleasable(*state, holders)) {
+      ++it;
+      continue;
+    }
+    Scine::Utils::UniqueIdentifier uid;
+    const std::string file = directory->path() + "state_" + uid.getStringRepresentation() + ".bin";
+    state->spill(file, std::move(directory));
+    it = _states.erase(it);
+    holders = this->holders();
+  }
+  return bytes(holders) <= limit;
+}
+
+size_t SerenityState::Tracker::bytes() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return bytes(this->holders());
+}
+
+SerenityState::Tracker::Holders SerenityState::Tracker::holders() const {
+  Holders holders;
+  for (const auto& tracked : _states) {
+    auto state = tracked.state.lock();
+    if (!state) {
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(state->_mutex);
+    for (const auto* data : {&state->_restricted, &state->_unrestricted}) {
+      if (*data) {
+        auto& holder = holders[data->get()];
+        holder.first = data->use_count();
+        ++holder.second;
+      }
+    }
+  }
+  return holders;
+}
+
+size_t SerenityState::Tracker::bytes(const Holders& holders) {
+  size_t bytes = 0;
+  for (const auto& holder : holders) {
+    if (holder.second.first == holder.second.second) {
+      bytes += holder.first->bytes();
+    }
+  }
+  return bytes;
+}
+
+bool SerenityState::Tracker::isReleasable(const SerenityState& state, const Holders& holders) {
+  std::lock_guard<std::mutex> lock(state._mutex);
+  for (const auto* data : {state._restricted.get(), state._unrestricted.get()}) {
+    if (data && holders.at(data).first != holders.at(data).second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void SerenityState::save(const std::string& file) const {
+  std::ofstream out(file, std::ios::binary | std::ios::trunc);
+  const auto nAtoms = static_cast<unsigned int>(_symbols.size());
+  out.write(reinterpret_cast<const char*>(&nAtoms), sizeof(nAtoms));
+  for (const auto& symbol : _symbols) {
+    const auto length = static_cast<unsigned int>(symbol.size());
+    out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.write(symbol.data(), length);
+  }
+  const Eigen::MatrixXd::Index rows = _coordinates.rows();
+  const Eigen::MatrixXd::Index cols = _coordinates.cols();
+  out.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+  out.write(reinterpret_cast<const char*>(&cols), sizeof(cols));
+  out.write(reinterpret_cast<const char*>(_coordinates.data()), rows * cols * sizeof(double));
+  const auto restricted = this->getRestrictedOrbitals();
+  const auto unrestricted = this->getUnrestrictedOrbitals();
+  const char flags[2] = {static_cast<char>(restricted != nullptr), static_cast<char>(unrestricted != nullptr)};
+  out.write(flags, sizeof(flags));
+  if (restricted) {
+    writeOrbitals(out, *restricted);
+  }
+  if (unrestricted) {
+    writeOrbitals(out, *unrestricted);
+  }
+  out.close();
+  if (!out) {
+    throw std::runtime_error("Failed to write the Serenity state '" + file + "'.");
+  }
+}
+
+std::shared_ptr<SerenityState> SerenityState::load(const std::string& file) {
+  std::ifstream in(file, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("Failed to open the Serenity state '" + file + "'.");
+  }
+  unsigned int nAtoms = 0;
+  in.read(reinterpret_cast<char*>(&nAtoms), sizeof(nAtoms));
+  std::vector<std::string> symbols(nAtoms);
+  for (auto& symbol : symbols) {
+    unsigned int length = 0;
+    in.read(reinterpret_cast<char*>(&length), sizeof(length));
+    symbol.resize(length);
+    in.read(&symbol[0], length);
+  }
+  Eigen::MatrixXd::Index rows = 0;
+  Eigen::MatrixXd::Index cols = 0;
+  in.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+  in.read(reinterpret_cast<char*>(&cols), sizeof(cols));
+  Eigen::MatrixXd coordinates(rows, cols);
+  in.read(reinterpret_cast<char*>(coordinates.data()), rows * cols * sizeof(double));
+  char flags[2] = {0, 0};
+  in.read(flags, sizeof(flags));
+  if (!in) {
+    throw std::runtime_error("Failed to read the Serenity state '" + file + "'.");
+  }
+  auto restricted = flags[0] ? readOrbitals(in) : nullptr;
+  auto unrestricted = flags[1] ? readOrbitals(in) : nullptr;
+  return std::make_shared<SerenityState>(std::move(symbols), std::move(coordinates), std::move(restricted),
+                                         std::move(unrestricted));
+}
+
+std::shared_ptr<const SerenityState::OrbitalData> SerenityState::read(bool restricted) const {
+  std::ifstream in(_file, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("Failed to open the spilled Serenity state '" + _file + "'.");
+  }
+  if (restricted) {
+    return readOrbitals(in);
+  }
+  // Skip the restricted block
+  if (_hasRestricted) {
+    readOrbitals(in);
+  }
+  return readOrbitals(in);
+}
+
+} /* namespace Serenity */
+} /* namespace Scine */
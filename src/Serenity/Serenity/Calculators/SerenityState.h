@@ -7,28 +7,151 @@
 #ifndef SERENITY_SERENITYSTATE_H_
 #define SERENITY_SERENITYSTATE_H_
 
-/* Serenity Includes*/
-#include <io/Filesystem.h>
-#include <settings/Settings.h>
-#include <system/SystemController.h>
+/* Wrapper Includes */
+#include "Serenity/Calculators/ScratchManager.h"
 /* Scine Includes */
 #include <Core/BaseClasses/StateHandableObject.h>
+/* External Includes */
+#include <Eigen/Dense>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
-namespace Sty = Serenity;
 namespace Scine {
 namespace Serenity {
 
 /**
  * @brief The definition of a loadable serenity state.
+ *
+ * A state holds the geometry and immutable, shared copies of the molecular orbitals.
+ * Taking a snapshot of an unchanged calculator and restoring it only copies pointers;
+ * the orbitals are only copied into Serenity's own data structures on restore.
+ * Once the orbitals held only by the states of one calculator exceed a memory limit, the
+ * least recently taken of these states (see Tracker) are written to disk and read back on
+ * demand, until the limit is met again.
  */
 class SerenityState : public Scine::Core::State {
  public:
-  SerenityState(std::shared_ptr<Sty::SystemController> s) : system(s){};
-  ~SerenityState() {
-    // TODO
-    //      remove_all(system->getSettings().path);
+  /**
+   * @brief Immutable molecular orbital data of one SCF mode.
+   *
+   * All vectors hold one entry (restricted) or two entries (alpha, beta; unrestricted).
+   */
+  class OrbitalData {
+   public:
+    OrbitalData(std::vector<Eigen::MatrixXd> coefficients, std::vector<Eigen::VectorXd> eigenvalues,
+                std::vector<unsigned int> nCoreOrbitals, std::vector<unsigned int> nOccupiedOrbitals);
+    OrbitalData(const OrbitalData& other) = delete;
+    OrbitalData& operator=(const OrbitalData& other) = delete;
+    const std::vector<Eigen::MatrixXd> coefficients;
+    const std::vector<Eigen::VectorXd> eigenvalues;
+    const std::vector<unsigned int> nCoreOrbitals;
+    const std::vector<unsigned int> nOccupiedOrbitals;
+    /// @brief The memory held by the coefficients and eigenvalues in bytes.
+    size_t bytes() const {
+      return _bytes;
+    }
+
+   private:
+    size_t _bytes;
+  };
+
+  /**
+   * @brief The states taken from one calculator, the least recently taken first.
+   *
+   * Only orbitals held by nothing but these states count towards the limit, spilling any
+   * other state (e.g. one sharing its orbitals with the calculator) would not free memory.
+   */
+  class Tracker {
+   public:
+    /**
+     * @brief Registers a state to be spilled by spillLeastRecent().
+     * @param state     The state, only referenced weakly.
+     * @param directory The scratch directory its orbitals are spilled into.
+     */
+    void track(const std::shared_ptr<SerenityState>& state, std::shared_ptr<const ScratchManager::Directory> directory);
+    /**
+     * @brief Spills tracked states in the order they were tracked until the orbitals they hold fit a limit.
+     * @param limit The memory limit in bytes.
+     * @return bool Whether bytes() is within the limit afterwards.
+     */
+    bool spillLeastRecent(size_t limit);
+    /// @brief The memory held by orbitals only referenced by the tracked states in bytes.
+    size_t bytes();
+
+   private:
+    struct TrackedState {
+      std::weak_ptr<SerenityState> state;
+      std::weak_ptr<const ScratchManager::Directory> directory;
+    };
+    /// @brief The owners of each orbital data held by a tracked state, and how many of them are tracked states.
+    using Holders = std::map<const OrbitalData*, std::pair<long, long>>;
+    Holders holders() const;
+    /// @brief The memory held by orbitals without other owners than the tracked states.
+    static size_t bytes(const Holders& holders);
+    /// @brief Whether the orbitals of a state have no other owners than the tracked states.
+    static bool isReleasable(const SerenityState& state, const Holders& holders);
+    std::list<TrackedState> _states;
+    std::mutex _mutex;
+  };
+
+  /**
+   * @brief Construct a new SerenityState.
+   * @param symbols      The atom symbols.
+   * @param coordinates  The coordinates.
+   * @param restricted   The restricted orbitals, may be nullptr.
+   * @param unrestricted The unrestricted orbitals, may be nullptr.
+   */
+  SerenityState(std::vector<std::string> symbols, Eigen::MatrixXd coordinates,
+                std::shared_ptr<const OrbitalData> restricted, std::shared_ptr<const OrbitalData> unrestricted);
+  ~SerenityState();
+  /// @brief Getter for the atom symbols.
+  const std::vector<std::string>& getAtomSymbols() const {
+    return _symbols;
+  }
+  /// @brief Getter for the coordinates.
+  const Eigen::MatrixXd& getCoordinates() const {
+    return _coordinates;
   }
-  std::shared_ptr<Sty::SystemController> system;
+  /// @brief Getter for the restricted orbitals, reads them from disk if they were spilled.
+  std::shared_ptr<const OrbitalData> getRestrictedOrbitals() const;
+  /// @brief Getter for the unrestricted orbitals, reads them from disk if they were spilled.
+  std::shared_ptr<const OrbitalData> getUnrestrictedOrbitals() const;
+  /**
+   * @brief Writes the orbitals to disk and releases them from memory.
+   * @param file      The file to be used, it is removed together with this state.
+   * @param directory The scratch directory holding the file, kept alive by this state.
+   */
+  void spill(const std::string& file, std::shared_ptr<const ScratchManager::Directory> directory);
+  /// @brief Whether the orbitals of this state live on disk.
+  bool isSpilled() const;
+  /**
+   * @brief Writes the whole state (atoms, coordinates and orbitals) into a file, e.g. for another process.
+   * @param file The file, overwritten.
+   */
+  void save(const std::string& file) const;
+  /**
+   * @brief Reads a state written by save().
+   * @param file The file.
+   * @return std::shared_ptr<SerenityState> The state, holding its orbitals in memory.
+   */
+  static std::shared_ptr<SerenityState> load(const std::string& file);
+
+ private:
+  std::shared_ptr<const OrbitalData> read(bool restricted) const;
+  std::vector<std::string> _symbols;
+  Eigen::MatrixXd _coordinates;
+  std::shared_ptr<const OrbitalData> _restricted;
+  std::shared_ptr<const OrbitalData> _unrestricted;
+  bool _hasRestricted;
+  bool _hasUnrestricted;
+  std::string _file;
+  std::shared_ptr<const ScratchManager::Directory> _directory;
+  /// @brief Guards the orbitals and the file, states may be spilled from another thread.
+  mutable std::mutex _mutex;
 };
 
 } /* namespace Serenity */
@@ -0,0 +1,33 @@
+/**
+ * @file
+ * @copyright This code is licensed under the 3-clause BSD license.\n
+ *            Copyright ETH Zurich, Department of Chemistry and Applied Biosciences, Reiher Group.\n
+ *            See LICENSE.txt for details.
+ */
+/* Internal Includes */
+#include "Serenity/Calculators/DisplacementJob.h"
+#include "Serenity/Calculators/DisplacementWorkerPool.h"
+/* External Includes */
+#include <exception>
+#include <iostream>
+#include <string>
+
+/*
+ * A worker process of the DisplacementWorkerPool:
+ *   serenity_displacement_worker <job file> <result file> <worker index> <number of workers>
+ */
+int main(int argc, char* argv[]) {
+  if (argc != 5) {
+    std::cerr << "Usage: serenity_displacement_worker <job> <results> <worker> <workers>" << std::endl;
+    return 2;
+  }
+  try {
+    Scine::Serenity::DisplacementJob job(argv[1]);
+    return Scine::Serenity::DisplacementWorkerPool::serve(argv[2], std::stoul(argv[3]), std::stoul(argv[4]), job.size(),
+                                                          [&](unsigned int task) { return job.run(task); });
+  }
+  catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
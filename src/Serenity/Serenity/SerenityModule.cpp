@@ -8,7 +8,9 @@
 #include "Serenity/SerenityModule.h"
 #include "Serenity/Calculators/CCCalculator.h"
 #include "Serenity/Calculators/DFTCalculator.h"
+#include "Serenity/Calculators/EmbeddingCalculator.h"
 #include "Serenity/Calculators/HFCalculator.h"
+#include "Serenity/Calculators/MP2Calculator.h"
 /* External Includes */
 #include <Core/DerivedModule.h>
 #include <Core/Exceptions.h>
@@ -22,8 +24,9 @@ std::string SerenityModule::name() const noexcept {
   return "Serenity";
 }
 
-using InterfaceModelMap =
-    boost::mpl::map<boost::mpl::pair<Scine::Core::Calculator, boost::mpl::vector<DFTCalculator, HFCalculator, CCCalculator>>>;
+using InterfaceModelMap = boost::mpl::map<boost::mpl::pair<
+    Scine::Core::Calculator,
+    boost::mpl::vector<DFTCalculator, HFCalculator, CCCalculator, EmbeddingCalculator, MP2Calculator>>>;
 
 boost::any SerenityModule::get(const std::string& interface, const std::string& model) const {
   boost::any resolved = Scine::Core::DerivedModule::resolve<InterfaceModelMap>(interface, model);